@@ -32,6 +32,10 @@ void fsm_init(FSM *fsm) {
 
 // Processa um byte na FSM
 bool fsm_process(FSM *fsm, uint8_t byte) {
+    // Após um quadro (completo ou com erro) o byte seguinte já pertence ao próximo quadro
+    if (fsm->currentState == STATE_COMPLETE || fsm->currentState == STATE_ERROR) {
+        fsm_init(fsm);
+    }
     switch (fsm->currentState) {
         case STATE_WAIT_STX:
             if (byte == 0x02) { // STX
@@ -40,7 +44,8 @@ bool fsm_process(FSM *fsm, uint8_t byte) {
             break;
         case STATE_READ_QTD:
             fsm->qtd = byte;
-            fsm->currentState = STATE_READ_DATA;
+            // Quadro sem dados segue direto para o CHK
+            fsm->currentState = byte ? STATE_READ_DATA : STATE_READ_CHK;
             break;
         case STATE_READ_DATA:
             fsm->data[fsm->dataIndex++] = byte;
@@ -0,0 +1,324 @@
+/**
+ * @file benchSuite.c
+ * @brief Bateria de medições de vazão de todos os decodificadores, com saída para máquina.
+ *
+ * Para cada combinação de tamanho de DADOS, taxa de erro de bit e taxa de lixo entre quadros, gera
+ * um fluxo de quadros e mede cada implementação do decodificador:
+ *
+ * - fsm_process (pse-2, decoderSwitch.c);
+ * - processByte, processBuffer e decodeFrames, sem e com escape;
+ * - decodeParallel com uma thread por núcleo.
+ *
+ * Em todos os casos o consumidor lê os DADOS de cada quadro correto (soma de verificação), como
+ * faria a aplicação. Cada linha da saída (CSV ou JSON, uma linha por medição) traz vazão do fluxo
+ * em MB/s, quadros corretos por segundo, ns por quadro e a quantidade de quadros corretos, que
+ * deve ser igual entre decodificadores do mesmo cenário.
+ *
+ *   benchSuite [-s tamanhos] [-b taxas] [-g taxas] [-m MB] [-t segundos] [-j] [-r rótulo]
+ *
+ *   -s  tamanhos de DADOS, separados por vírgula; "a" = uniforme de 0 a 255 (padrão 0,16,64,255,a)
+ *   -b  probabilidades de troca de cada bit do fluxo (padrão 0,1e-5,1e-3)
+ *   -g  fração do fluxo composta por lixo entre quadros (padrão 0,0.1)
+ *   -m  tamanho aproximado de cada fluxo em MB (padrão 2)
+ *   -t  tempo mínimo de cada medição em segundos (padrão 0.1)
+ *   -j  saída em JSON (uma linha por medição) em vez de CSV
+ *   -r  rótulo incluído em cada linha (por exemplo o hash do commit)
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#include <unistd.h>
+
+#include "protocol.h"
+#include "parallelDecoder.h"
+#include "decoderSwitch.h"
+
+#define MAX_LIST   16
+#define RANDOM_QTD -1 // Tamanho uniforme de 0 a MAX_DATA
+
+typedef struct {
+    int qtd;          // Tamanho dos DADOS ou RANDOM_QTD
+    double bitErrors; // Probabilidade de troca de cada bit
+    double garbage;   // Fração do fluxo composta por lixo
+} Scenario;
+
+typedef struct {
+    const char *name;
+    bool escaped;
+    long (*decode)(const uint8_t *buf, size_t len, bool escaped);
+} Decoder;
+
+static double minTime = 0.1;
+static int threads = 1;
+static volatile uint8_t sink; // Impede que o compilador descarte a leitura dos DADOS
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* xorshift64; reiniciado para cada fluxo, de modo que um cenário gera sempre os mesmos bytes */
+static uint64_t rngState = 88172645463325252ull;
+
+static uint64_t nextRandom(void) {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 7;
+    rngState ^= rngState << 17;
+    return rngState;
+}
+
+/* Número uniforme em [0, 1) */
+static double uniform(void) {
+    return (nextRandom() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/* Gera o fluxo do cenário: quadros, lixo entre eles e, por fim, os bits trocados */
+static uint8_t * buildStream(const Scenario *scenario, bool escaped, size_t target, size_t *len) {
+    size_t capacity = target + MAX_FRAME_SIZE;
+    uint8_t *stream = malloc(capacity);
+    uint8_t payload[MAX_DATA];
+    double garbage = 0;
+    size_t n = 0;
+
+    rngState = 88172645463325252ull;
+    while (n < target) {
+        if (capacity - n < MAX_FRAME_SIZE) {
+            capacity *= 2;
+            stream = realloc(stream, capacity);
+        }
+        int qtd = scenario->qtd == RANDOM_QTD ? (int)(nextRandom() % (MAX_DATA + 1)) : scenario->qtd;
+        for (int i = 0; i < qtd; i++) {
+            payload[i] = (uint8_t)nextRandom();
+        }
+        size_t size = encodeFrame(payload, (uint8_t)qtd, stream + n, escaped);
+        n += size;
+
+        // Lixo proporcional ao quadro, para que seja a fração pedida do fluxo
+        garbage += scenario->garbage / (1 - scenario->garbage) * size;
+        for (; garbage >= 1 && n < capacity; garbage -= 1) {
+            stream[n++] = (uint8_t)nextRandom();
+        }
+    }
+
+    if (scenario->bitErrors > 0) {
+        // Distância geométrica entre bits trocados
+        double logKeep = log1p(-scenario->bitErrors);
+        for (double bit = floor(log(1 - uniform()) / logKeep); bit < n * 8.0;
+             bit += 1 + floor(log(1 - uniform()) / logKeep)) {
+            stream[(size_t)bit / 8] ^= (uint8_t)(1 << ((size_t)bit % 8));
+        }
+    }
+    *len = n;
+    return stream;
+}
+
+static void newFSM(FSM *fsm, bool escaped) {
+    resetFSM(fsm);
+    setEscapedMode(fsm, escaped);
+}
+
+static long switchFrames;
+
+static void consumeSwitch(void *ctx, size_t end, const uint8_t *data, uint8_t length, uint8_t chk) {
+    (void)ctx;
+    (void)end;
+    uint8_t sum = computeChecksum(data, length);
+    if (sum == chk) {
+        sink = sum;
+        switchFrames++;
+    }
+}
+
+static long decodeSwitch(const uint8_t *buf, size_t len, bool escaped) {
+    (void)escaped;
+    switchFrames = 0;
+    switchDecode(buf, len, consumeSwitch, NULL);
+    return switchFrames;
+}
+
+static long decodeByteByByte(const uint8_t *buf, size_t len, bool escaped) {
+    FSM fsm;
+    long frames = 0;
+
+    newFSM(&fsm, escaped);
+    for (size_t i = 0; i < len; i++) {
+        if (processByte(&fsm, buf[i]) && checksumOk(&fsm)) {
+            sink = computeChecksum(fsm.data, fsm.qtd);
+            frames++;
+        }
+    }
+    return frames;
+}
+
+static long decodeBlock(const uint8_t *buf, size_t len, bool escaped) {
+    FSM fsm;
+    long frames = 0;
+    size_t pos = 0;
+
+    newFSM(&fsm, escaped);
+    while (pos < len) {
+        bool complete;
+        pos += processBuffer(&fsm, buf + pos, len - pos, &complete);
+        if (complete && checksumOk(&fsm)) {
+            sink = computeChecksum(fsm.data, fsm.qtd);
+            frames++;
+        }
+    }
+    return frames;
+}
+
+static long decodeZeroCopy(const uint8_t *buf, size_t len, bool escaped) {
+    Frame frames[64];
+    FSM fsm;
+    long total = 0;
+    size_t pos = 0;
+
+    newFSM(&fsm, escaped);
+    while (pos < len) {
+        size_t used;
+        size_t count = decodeFrames(&fsm, buf + pos, len - pos, frames, 64, &used);
+        for (size_t f = 0; f < count; f++) {
+            if (frames[f].status == FRAME_OK) {
+                sink = computeChecksum(frames[f].payload, frames[f].length);
+                total++;
+            }
+        }
+        pos += used;
+    }
+    return total;
+}
+
+static long decodeThreads(const uint8_t *buf, size_t len, bool escaped) {
+    FrameList list;
+    long total = 0;
+
+    (void)escaped;
+    decodeParallel(buf, len, threads, &list);
+    for (size_t f = 0; f < list.count; f++) {
+        if (list.records[f].status == FRAME_OK) {
+            sink = computeChecksum(buf + list.records[f].payload, list.records[f].length);
+            total++;
+        }
+    }
+    freeFrameList(&list);
+    return total;
+}
+
+static const Decoder decoders[] = {
+    {"fsm_process",          false, decodeSwitch},
+    {"processByte",          false, decodeByteByByte},
+    {"processBuffer",        false, decodeBlock},
+    {"decodeFrames",         false, decodeZeroCopy},
+    {"decodeParallel",       false, decodeThreads},
+    {"processByte+escape",   true,  decodeByteByByte},
+    {"processBuffer+escape", true,  decodeBlock},
+    {"decodeFrames+escape",  true,  decodeZeroCopy},
+};
+
+/* Repete a decodificação até somar minTime segundos; devolve o tempo por passada */
+static double measure(const Decoder *decoder, const uint8_t *buf, size_t len, long *frames) {
+    long passes = 0;
+    double start, elapsed;
+
+    *frames = decoder->decode(buf, len, decoder->escaped); // Aquecimento
+    start = now();
+    do {
+        decoder->decode(buf, len, decoder->escaped);
+        passes++;
+        elapsed = now() - start;
+    } while (elapsed < minTime);
+    return elapsed / passes;
+}
+
+static int parseList(char *arg, double *values) {
+    int count = 0;
+    for (char *item = strtok(arg, ","); item != NULL && count < MAX_LIST; item = strtok(NULL, ",")) {
+        values[count++] = strcmp(item, "a") == 0 ? RANDOM_QTD : atof(item);
+    }
+    return count;
+}
+
+int main(int argc, char *argv[]) {
+    double sizes[MAX_LIST] = {0, 16, 64, 255, RANDOM_QTD};
+    double bitErrors[MAX_LIST] = {0, 1e-5, 1e-3};
+    double garbage[MAX_LIST] = {0, 0.1};
+    int sizeCount = 5, bitErrorCount = 3, garbageCount = 2;
+    size_t target = 2000000;
+    const char *label = "";
+    bool json = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:b:g:m:t:jr:")) != -1) {
+        switch (opt) {
+            case 's': sizeCount = parseList(optarg, sizes); break;
+            case 'b': bitErrorCount = parseList(optarg, bitErrors); break;
+            case 'g': garbageCount = parseList(optarg, garbage); break;
+            case 'm': target = (size_t)(atof(optarg) * 1e6); break;
+            case 't': minTime = atof(optarg); break;
+            case 'j': json = true; break;
+            case 'r': label = optarg; break;
+            default:
+                fprintf(stderr, "uso: %s [-s tamanhos] [-b taxas] [-g taxas] [-m MB] [-t segundos] "
+                        "[-j] [-r rótulo]\n", argv[0]);
+                return 2;
+        }
+    }
+    threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (!json) {
+        printf("rotulo,decodificador,tamanho,ber,lixo,bytes,quadros,mb_s,quadros_s,ns_quadro\n");
+    }
+    for (int s = 0; s < sizeCount; s++) {
+        for (int b = 0; b < bitErrorCount; b++) {
+            for (int g = 0; g < garbageCount; g++) {
+                Scenario scenario = {(int)sizes[s], bitErrors[b], garbage[g]};
+                uint8_t *streams[2];
+                size_t lens[2];
+                char size[12];
+
+                if (scenario.garbage < 0 || scenario.garbage >= 1 || scenario.qtd > MAX_DATA) {
+                    fprintf(stderr, "cenário inválido ignorado\n");
+                    continue;
+                }
+                streams[0] = buildStream(&scenario, false, target, &lens[0]);
+                streams[1] = buildStream(&scenario, true, target, &lens[1]);
+                if (scenario.qtd == RANDOM_QTD) {
+                    strcpy(size, "a");
+                } else {
+                    snprintf(size, sizeof(size), "%d", scenario.qtd);
+                }
+
+                for (size_t d = 0; d < sizeof(decoders) / sizeof(decoders[0]); d++) {
+                    const Decoder *decoder = &decoders[d];
+                    size_t len = lens[decoder->escaped];
+                    long frames;
+                    double elapsed = measure(decoder, streams[decoder->escaped], len, &frames);
+                    double mbs = len / elapsed / 1e6;
+                    double fps = frames / elapsed;
+                    double nsFrame = frames ? elapsed * 1e9 / frames : 0;
+
+                    if (json) {
+                        printf("{\"rotulo\":\"%s\",\"decodificador\":\"%s\",\"tamanho\":\"%s\","
+                               "\"ber\":%g,\"lixo\":%g,\"bytes\":%zu,\"quadros\":%ld,\"mb_s\":%.2f,"
+                               "\"quadros_s\":%.0f,\"ns_quadro\":%.2f}\n", label, decoder->name,
+                               size, scenario.bitErrors, scenario.garbage, len, frames, mbs, fps,
+                               nsFrame);
+                    } else {
+                        printf("%s,%s,%s,%g,%g,%zu,%ld,%.2f,%.0f,%.2f\n", label, decoder->name, size,
+                               scenario.bitErrors, scenario.garbage, len, frames, mbs, fps, nsFrame);
+                    }
+                    fflush(stdout);
+                }
+                free(streams[0]);
+                free(streams[1]);
+            }
+        }
+    }
+    return 0;
+}
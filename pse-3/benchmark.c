@@ -0,0 +1,237 @@
+/**
+ * @file benchmark.c
+ * @brief Medição de vazão do decodificador de protocolo (protocol.c).
+ *
+ * Gera um fluxo de quadros com dados aleatórios (que contêm STX, ETX e DLE com a frequência natural
+ * de 3/256) e mede a vazão da decodificação byte a byte (processByte), em bloco (processBuffer)
+ * e sem cópia (decodeFrames), com e sem escape. Nos dois últimos casos o consumidor lê os DADOS
+ * entregues (soma de verificação), como faria a aplicação.
+ *
+ * Com o argumento "paralelo", mede a escalabilidade de decodeParallel com 1 a 2x o número de
+ * núcleos sobre uma captura de CAPTURA_MB megabytes.
+ *
+ * Com o argumento "v2", compara transferências de TRANSFERENCIA bytes em quadros da versão 1
+ * (fatiadas em quadros de MAX_DATA - 1 bytes, o máximo da v1 com a v2 habilitada) e em um único
+ * quadro da versão 2.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#include <unistd.h>
+
+#include "protocol.h"
+#include "parallelDecoder.h"
+
+#define FRAMES     20000 // Quadros no fluxo de teste
+#define REPETICOES 20    // Passadas sobre o fluxo
+#define CAPTURA_MB 256   // Tamanho da captura no teste de escalabilidade
+#define TRANSFERENCIA 4096 // Tamanho de cada transferência no teste da versão 2
+#define TRANSFERENCIAS 4000
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Gera quadros com tamanho e conteúdo pseudoaleatórios */
+static uint8_t * buildFrames(bool escaped, long frames, size_t *len) {
+    uint8_t *stream = malloc((size_t)frames * MAX_FRAME_SIZE);
+    uint8_t payload[MAX_DATA];
+    size_t n = 0;
+
+    srand(1234);
+    for (long f = 0; f < frames; f++) {
+        uint8_t qtd = (uint8_t)(rand() % (MAX_DATA + 1));
+        for (int i = 0; i < qtd; i++) {
+            payload[i] = (uint8_t)rand();
+        }
+        n += encodeFrame(payload, qtd, stream + n, escaped);
+    }
+    *len = n;
+    return stream;
+}
+
+static uint8_t * buildStream(bool escaped, size_t *len) {
+    return buildFrames(escaped, FRAMES, len);
+}
+
+static long decodeByteByByte(FSM *fsm, const uint8_t *buf, size_t len) {
+    long frames = 0;
+    for (size_t i = 0; i < len; i++) {
+        frames += processByte(fsm, buf[i]);
+    }
+    return frames;
+}
+
+static volatile uint8_t sink; // Impede que o compilador descarte a leitura dos DADOS
+
+static long decodeBlock(FSM *fsm, const uint8_t *buf, size_t len) {
+    uint8_t data[MAX_DATA];
+    long frames = 0;
+    size_t pos = 0;
+    while (pos < len) {
+        bool complete;
+        pos += processBuffer(fsm, buf + pos, len - pos, &complete);
+        if (complete) {
+            // A aplicação precisa copiar os dados antes do próximo quadro
+            memcpy(data, fsm->data, fsm->qtd);
+            sink = computeChecksum(data, fsm->qtd);
+            frames++;
+        }
+    }
+    return frames;
+}
+
+static long decodeZeroCopy(FSM *fsm, const uint8_t *buf, size_t len) {
+    Frame frames[64];
+    long total = 0;
+    size_t pos = 0;
+    while (pos < len) {
+        size_t used;
+        size_t count = decodeFrames(fsm, buf + pos, len - pos, frames, 64, &used);
+        for (size_t f = 0; f < count; f++) {
+            sink = computeChecksum(frames[f].payload, frames[f].length);
+            total += frames[f].status == FRAME_OK;
+        }
+        pos += used;
+    }
+    return total;
+}
+
+static void run(const char *name, bool escaped, long (*decode)(FSM *, const uint8_t *, size_t)) {
+    size_t len;
+    uint8_t *stream = buildStream(escaped, &len);
+    FSM fsm;
+    long frames = 0;
+    double start;
+
+    resetFSM(&fsm);
+    setEscapedMode(&fsm, escaped);
+    start = now();
+    for (int r = 0; r < REPETICOES; r++) {
+        frames += decode(&fsm, stream, len);
+    }
+    double elapsed = now() - start;
+
+    printf("%-24s %8.1f MB/s %8.2f Mquadros/s %s\n", name,
+           (double)len * REPETICOES / elapsed / 1e6, frames / elapsed / 1e6,
+           frames == (long)FRAMES * REPETICOES ? "" : "(quadros perdidos!)");
+    free(stream);
+}
+
+static void runParallel(void) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    long frames = (long)CAPTURA_MB * 1000000 / (MAX_DATA / 2 + 4);
+    size_t len;
+    uint8_t *stream = buildFrames(false, frames, &len);
+    double base = 0;
+
+    printf("captura: %.1f MB, %ld núcleos\n", len / 1e6, cores);
+    {
+        // Aquecimento: primeira passada paga as faltas de página da captura
+        FrameList list;
+        decodeSequential(stream, len, &list);
+        freeFrameList(&list);
+    }
+    for (int threads = 1; threads <= 2 * cores; threads++) {
+        FrameList list;
+        double start = now();
+        decodeParallel(stream, len, threads, &list);
+        double elapsed = now() - start;
+        if (threads == 1) {
+            base = elapsed;
+        }
+        printf("threads=%-3d %8.1f MB/s  speedup %.2fx  quadros=%zu\n", threads,
+               len / elapsed / 1e6, base / elapsed, list.count);
+        freeFrameList(&list);
+    }
+    free(stream);
+}
+
+/* Codifica TRANSFERENCIAS transferências de TRANSFERENCIA bytes na versão indicada */
+static uint8_t * buildTransfers(int version, size_t *len) {
+    static uint8_t payload[TRANSFERENCIA];
+    uint8_t *stream = malloc((size_t)TRANSFERENCIAS * FRAME_V2_SIZE(TRANSFERENCIA));
+    size_t n = 0;
+
+    for (size_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = (uint8_t)rand();
+    }
+    for (int t = 0; t < TRANSFERENCIAS; t++) {
+        if (version == 2) {
+            n += encodeFrameV2(payload, TRANSFERENCIA, stream + n, false);
+            continue;
+        }
+        for (size_t off = 0; off < TRANSFERENCIA; off += MAX_DATA - 1) {
+            size_t qtd = TRANSFERENCIA - off < MAX_DATA - 1 ? TRANSFERENCIA - off : MAX_DATA - 1;
+            n += encodeFrame(payload + off, (uint8_t)qtd, stream + n, false);
+        }
+    }
+    *len = n;
+    return stream;
+}
+
+static void runTransfers(int version, bool zeroCopy) {
+    static uint8_t v2Buffer[TRANSFERENCIA];
+    size_t len;
+    uint8_t *stream = buildTransfers(version, &len);
+    long frames = 0, payload = 0;
+    FSM fsm;
+
+    resetFSM(&fsm);
+    enableProtocolV2(&fsm, v2Buffer, sizeof(v2Buffer));
+    double start = now();
+    for (int r = 0; r < REPETICOES; r++) {
+        size_t pos = 0;
+        while (pos < len) {
+            if (zeroCopy) {
+                Frame out[64];
+                size_t used, count = decodeFrames(&fsm, stream + pos, len - pos, out, 64, &used);
+                for (size_t f = 0; f < count; f++) {
+                    frames += out[f].status == FRAME_OK;
+                    payload += out[f].length;
+                }
+                pos += used;
+            } else {
+                bool complete;
+                pos += processBuffer(&fsm, stream + pos, len - pos, &complete);
+                if (complete && checksumOk(&fsm)) {
+                    frames++;
+                    payload += fsm.qtd;
+                }
+            }
+        }
+    }
+    double elapsed = now() - start;
+
+    printf("v%d %-14s %8.1f MB/s de dados %8.2f Mquadros/s  overhead %5.2f%%\n", version,
+           zeroCopy ? "decodeFrames" : "processBuffer", payload / elapsed / 1e6,
+           frames / elapsed / 1e6, 100.0 * (len - (double)payload / REPETICOES) / len);
+    free(stream);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 1 && strcmp(argv[1], "v2") == 0) {
+        runTransfers(1, false);
+        runTransfers(2, false);
+        runTransfers(1, true);
+        runTransfers(2, true);
+        return 0;
+    }
+    if (argc > 1 && strcmp(argv[1], "paralelo") == 0) {
+        runParallel();
+        return 0;
+    }
+    run("processByte", false, decodeByteByByte);
+    run("processByte+escape", true, decodeByteByByte);
+    run("processBuffer", false, decodeBlock);
+    run("processBuffer+escape", true, decodeBlock);
+    run("decodeFrames", false, decodeZeroCopy);
+    run("decodeFrames+escape", true, decodeZeroCopy);
+    return 0;
+}
@@ -0,0 +1,19 @@
+/**
+ * @file crc16.h
+ * @brief CRC-16/CCITT usado pelos quadros da versão 2 do protocolo.
+ */
+#ifndef CRC16_H
+#define CRC16_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CRC16_INIT 0xFFFF
+
+/** Continua o cálculo do CRC a partir de crc sobre mais len bytes. */
+uint16_t crc16Update(uint16_t crc, const uint8_t *data, size_t len);
+
+/** CRC-16/CCITT de um bloco (valor de verificação de "123456789": 0x29B1). */
+uint16_t crc16(const uint8_t *data, size_t len);
+
+#endif // CRC16_H
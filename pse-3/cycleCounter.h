@@ -0,0 +1,64 @@
+/**
+ * @file cycleCounter.h
+ * @brief Contador de ciclos para a instrumentação do decodificador (PROTOCOL_STATS).
+ *
+ * - x86 (host): instrução rdtsc.
+ * - Cortex-M3/M4/M7: contador DWT->CYCCNT (habilitado por cycleCounterInit).
+ * - Cortex-M0/M0+ (SAMD21, sem DWT): valor do SysTick, que conta para baixo e recarrega com
+ *   SYST_RVR; intervalos maiores que um período do SysTick não são medidos corretamente.
+ * - Outras plataformas: clock_gettime em nanossegundos.
+ *
+ * cycleCounterElapsed(início, fim) devolve o intervalo já considerando o sentido da contagem.
+ */
+#ifndef CYCLE_COUNTER_H
+#define CYCLE_COUNTER_H
+
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <x86intrin.h>
+
+static inline void cycleCounterInit(void) {}
+static inline uint32_t cycleCounter(void) { return (uint32_t)__rdtsc(); }
+static inline uint32_t cycleCounterElapsed(uint32_t start, uint32_t end) { return end - start; }
+
+#elif defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+
+#define DEMCR      ( ( volatile uint32_t *) 0xe000edfc )
+#define DWT_CTRL   ( ( volatile uint32_t *) 0xe0001000 )
+#define DWT_CYCCNT ( ( volatile uint32_t *) 0xe0001004 )
+
+static inline void cycleCounterInit(void) {
+    *(DEMCR) |= 0x01000000; // TRCENA
+    *(DWT_CTRL) |= 1;       // CYCCNTENA
+}
+static inline uint32_t cycleCounter(void) { return *(DWT_CYCCNT); }
+static inline uint32_t cycleCounterElapsed(uint32_t start, uint32_t end) { return end - start; }
+
+#elif defined(__ARM_ARCH_6M__)
+
+#define SYST_RVR ( ( volatile uint32_t *) 0xe000e014 )
+#define SYST_CVR ( ( volatile uint32_t *) 0xe000e018 )
+
+static inline void cycleCounterInit(void) {} // SysTick já configurado pelo sistema
+static inline uint32_t cycleCounter(void) { return *(SYST_CVR); }
+static inline uint32_t cycleCounterElapsed(uint32_t start, uint32_t end) {
+    return start >= end ? start - end : start + (*(SYST_RVR) + 1) - end;
+}
+
+#else
+
+#include <time.h>
+
+static inline void cycleCounterInit(void) {}
+static inline uint32_t cycleCounter(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000000000u + ts.tv_nsec);
+}
+static inline uint32_t cycleCounterElapsed(uint32_t start, uint32_t end) { return end - start; }
+
+#endif
+
+#endif // CYCLE_COUNTER_H
@@ -0,0 +1,26 @@
+/**
+ * @file decoderSwitch.c
+ * @brief Adaptador do decodificador baseado em switch (pse-2) para o teste diferencial.
+ *
+ * Inclui pse-2/transmissionFsm.c, com o main dele renomeado para não colidir com o do programa
+ * de teste. Para o teste diferencial, o transmissionFsm.c foi corrigido para voltar a esperar o
+ * STX depois de um quadro completo ou com erro e para aceitar quadros com QTD 0. Como esta
+ * unidade de compilação não inclui protocol.h, os nomes State e FSM do pse-2 não conflitam com
+ * os do pse-3.
+ */
+#define main transmissionFsm_main
+#include "../pse-2/transmissionFsm.c"
+#undef main
+
+#include "decoderSwitch.h"
+
+void switchDecode(const uint8_t *buf, size_t len, SwitchFrameHandler handler, void *ctx) {
+    FSM fsm;
+
+    fsm_init(&fsm);
+    for (size_t i = 0; i < len; i++) {
+        if (fsm_process(&fsm, buf[i])) {
+            handler(ctx, i + 1, fsm.data, fsm.qtd, fsm.chk);
+        }
+    }
+}
@@ -0,0 +1,17 @@
+/**
+ * @file decoderSwitch.h
+ * @brief Interface do decodificador do pse-2 (fsm_process) para o teste diferencial.
+ */
+#ifndef DECODER_SWITCH_H
+#define DECODER_SWITCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Chamada para cada quadro completo: posição logo após o ETX, DADOS, QTD e CHK recebido
+typedef void (*SwitchFrameHandler)(void *ctx, size_t end, const uint8_t *data, uint8_t length, uint8_t chk);
+
+/** Decodifica o bloco inteiro com fsm_process, chamando handler para cada quadro completo. */
+void switchDecode(const uint8_t *buf, size_t len, SwitchFrameHandler handler, void *ctx);
+
+#endif // DECODER_SWITCH_H
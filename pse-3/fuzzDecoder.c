@@ -0,0 +1,418 @@
+/**
+ * @file fuzzDecoder.c
+ * @brief Teste diferencial entre as implementações do decodificador.
+ *
+ * A mesma entrada é decodificada por processByte (referência), processBuffer e decodeFrames com
+ * blocos de tamanho aleatório, decodeParallel e o decodificador baseado em switch do pse-2
+ * (decoderSwitch.c). Cada quadro terminado vira um evento (posição do fim, tamanho, versão,
+ * resultado e hash dos DADOS); qualquer diferença entre as listas de eventos é uma divergência.
+ *
+ * O primeiro byte da entrada escolhe a configuração: bit 0 = modo com escape, bit 1 = versão 2
+ * habilitada, bit 2 = buffer v2 de só V2_SMALL_CAPACITY bytes (quadros maiores terminam com
+ * FRAME_BAD_LENGTH), bits 3 em diante = semente da divisão em blocos. O restante é o fluxo de
+ * bytes. decodeParallel e o pse-2 só participam no modo sem escape e sem a versão 2. Com o
+ * buffer pequeno, decodeFrames só é comparado no modo com escape: sem escape, ele entrega sem
+ * cópia (e sem erro) os quadros grandes que chegam inteiros no bloco.
+ *
+ * Compilado com -DFUZZING, expõe LLVMFuzzerTestOneInput (libFuzzer; AFL++ também o aceita) e
+ * aborta na primeira divergência. Sem essa opção, gera fluxos aleatórios estruturados (quadros,
+ * ruído, bits trocados, quadros truncados) ou lê os arquivos dados na linha de comando:
+ *
+ *   fuzzDecoder [-n iterações] [-s semente] [arquivos...]
+ *
+ * Uma entrada que diverge é gravada em divergencia.bin para reprodução.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "protocol.h"
+#include "parallelDecoder.h"
+#include "decoderSwitch.h"
+
+#define CONFIG_ESCAPED 0x01
+#define CONFIG_V2      0x02
+#define CONFIG_SMALL   0x04
+
+#define V2_SMALL_CAPACITY 100 // Buffer v2 da configuração CONFIG_SMALL
+
+#define MAX_CHUNK 300 // Maior bloco entregue a processBuffer/decodeFrames
+
+// Quadro terminado, como visto por uma implementação
+typedef struct {
+    size_t end;       // Posição no fluxo logo após o último byte do quadro
+    uint16_t length;
+    uint8_t version;
+    FrameStatus status;
+    uint32_t hash;    // Hash dos DADOS (só para quadros completos)
+} Event;
+
+typedef struct {
+    Event *events;
+    size_t count;
+    size_t capacity;
+} EventList;
+
+static uint8_t v2Buffer[MAX_DATA_V2];
+
+/* FNV-1a */
+static uint32_t hashData(const uint8_t *data, size_t len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static uint32_t nextRandom(uint32_t *state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+static inline bool isComplete(FrameStatus status) {
+    return status == FRAME_OK || status == FRAME_BAD_CHECKSUM;
+}
+
+static void addEvent(EventList *list, size_t end, uint16_t length, uint8_t version,
+                     FrameStatus status, const uint8_t *data) {
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? 2 * list->capacity : 256;
+        list->events = realloc(list->events, list->capacity * sizeof(Event));
+    }
+    Event *event = &list->events[list->count++];
+    event->end = end;
+    event->length = length;
+    event->version = version;
+    event->status = status;
+    event->hash = isComplete(status) ? hashData(data, length) : 0;
+}
+
+static void newFSM(FSM *fsm, uint8_t config) {
+    resetFSM(fsm);
+    setEscapedMode(fsm, config & CONFIG_ESCAPED);
+    if (config & CONFIG_V2) {
+        enableProtocolV2(fsm, v2Buffer, config & CONFIG_SMALL ? V2_SMALL_CAPACITY : sizeof(v2Buffer));
+    }
+}
+
+/* Quadro terminado por processByte/processBuffer */
+static void addFsmEvent(EventList *list, const FSM *fsm, size_t end) {
+    addEvent(list, end, fsm->qtd, fsm->version, frameStatus(fsm), frameData(fsm));
+}
+
+static void runProcessByte(const uint8_t *buf, size_t len, uint8_t config, EventList *list) {
+    FSM fsm;
+
+    newFSM(&fsm, config);
+    for (size_t i = 0; i < len; i++) {
+        processByte(&fsm, buf[i]);
+        if (fsm.currentState >= STATE_COMPLETE) {
+            addFsmEvent(list, &fsm, i + 1);
+        }
+    }
+}
+
+static void runProcessBuffer(const uint8_t *buf, size_t len, uint8_t config, uint32_t seed,
+                             EventList *list) {
+    FSM fsm;
+    size_t pos = 0;
+
+    newFSM(&fsm, config);
+    while (pos < len) {
+        size_t chunk = 1 + nextRandom(&seed) % MAX_CHUNK;
+        bool complete;
+        if (chunk > len - pos) {
+            chunk = len - pos;
+        }
+        pos += processBuffer(&fsm, buf + pos, chunk, &complete);
+        if (fsm.currentState >= STATE_COMPLETE) {
+            addFsmEvent(list, &fsm, pos);
+        }
+    }
+}
+
+static void runDecodeFrames(const uint8_t *buf, size_t len, uint8_t config, uint32_t seed,
+                            EventList *list) {
+    Frame frames[8];
+    FSM fsm;
+    size_t pos = 0;
+
+    newFSM(&fsm, config);
+    while (pos < len) {
+        size_t chunk = 1 + nextRandom(&seed) % MAX_CHUNK;
+        size_t maxFrames = 1 + nextRandom(&seed) % 8;
+        size_t used;
+        if (chunk > len - pos) {
+            chunk = len - pos;
+        }
+        size_t count = decodeFrames(&fsm, buf + pos, chunk, frames, maxFrames, &used);
+        for (size_t i = 0; i < count; i++) {
+            addEvent(list, pos + frames[i].end, frames[i].length, frames[i].version,
+                     frames[i].status, frames[i].payload);
+        }
+        pos += used;
+    }
+}
+
+static void runParallel(const uint8_t *buf, size_t len, uint32_t seed, EventList *list) {
+    FrameList frames;
+
+    decodeParallel(buf, len, 1 + nextRandom(&seed) % 4, &frames);
+    for (size_t i = 0; i < frames.count; i++) {
+        const FrameRecord *record = &frames.records[i];
+        addEvent(list, record->end, record->length, 1, record->status, buf + record->payload);
+    }
+    freeFrameList(&frames);
+}
+
+static void switchFrame(void *ctx, size_t end, const uint8_t *data, uint8_t length, uint8_t chk) {
+    FrameStatus status = computeChecksum(data, length) == chk ? FRAME_OK : FRAME_BAD_CHECKSUM;
+    addEvent(ctx, end, length, 1, status, data);
+}
+
+/* Primeiro evento divergente, ou -1 se as listas são iguais */
+static long firstDifference(const EventList *expected, const EventList *result) {
+    size_t i;
+
+    for (i = 0; i < expected->count && i < result->count; i++) {
+        const Event *a = &expected->events[i], *b = &result->events[i];
+        if (a->end != b->end || a->status != b->status || a->version != b->version ||
+            (isComplete(a->status) && (a->length != b->length || a->hash != b->hash))) {
+            return (long)i;
+        }
+    }
+    return expected->count == result->count ? -1 : (long)i;
+}
+
+/**
+ * Decodifica a entrada com todas as implementações.
+ * Retorna o nome da primeira implementação que divergiu da referência, ou NULL.
+ */
+static const char * differential(const uint8_t *data, size_t size, long *index) {
+    const char *failed = NULL;
+
+    if (size == 0) {
+        return NULL;
+    }
+
+    uint8_t config = data[0];
+    uint32_t seed = 0x9e3779b9u ^ (config >> 3);
+    const uint8_t *buf = data + 1;
+    size_t len = size - 1;
+    bool plainV1 = (config & (CONFIG_ESCAPED | CONFIG_V2)) == 0;
+    EventList expected = {0}, result = {0};
+
+    runProcessByte(buf, len, config, &expected);
+
+    runProcessBuffer(buf, len, config, seed, &result);
+    if ((*index = firstDifference(&expected, &result)) >= 0) {
+        failed = "processBuffer";
+        goto done;
+    }
+
+    bool zeroCopyDiffers = (config & (CONFIG_V2 | CONFIG_SMALL | CONFIG_ESCAPED)) == (CONFIG_V2 | CONFIG_SMALL);
+    if (!zeroCopyDiffers) {
+        result.count = 0;
+        runDecodeFrames(buf, len, config, seed, &result);
+        if ((*index = firstDifference(&expected, &result)) >= 0) {
+            failed = "decodeFrames";
+            goto done;
+        }
+    }
+
+    if (plainV1) {
+        result.count = 0;
+        runParallel(buf, len, seed, &result);
+        if ((*index = firstDifference(&expected, &result)) >= 0) {
+            failed = "decodeParallel";
+            goto done;
+        }
+
+        // O pse-2 não sinaliza quadros com erro: compara só os quadros completos
+        size_t kept = 0;
+        for (size_t i = 0; i < expected.count; i++) {
+            if (isComplete(expected.events[i].status)) {
+                expected.events[kept++] = expected.events[i];
+            }
+        }
+        expected.count = kept;
+        result.count = 0;
+        switchDecode(buf, len, switchFrame, &result);
+        if ((*index = firstDifference(&expected, &result)) >= 0) {
+            failed = "fsm_process (pse-2)";
+            goto done;
+        }
+    }
+
+done:
+    free(expected.events);
+    free(result.events);
+    return failed;
+}
+
+#ifdef FUZZING
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    long index;
+    if (differential(data, size, &index) != NULL) {
+        abort();
+    }
+    return 0;
+}
+
+#else
+
+/* Fluxo aleatório estruturado: quadros válidos, ruído, bits trocados e quadros truncados */
+static size_t buildStream(uint32_t *seed, uint8_t *out, size_t capacity) {
+    uint8_t config = (uint8_t)nextRandom(seed);
+    bool escaped = config & CONFIG_ESCAPED;
+    bool v2 = config & CONFIG_V2;
+    uint8_t *frame = malloc(2 * FRAME_V2_SIZE(2048));
+    uint8_t payload[2048];
+    size_t n = 1;
+
+    out[0] = config;
+    for (int f = nextRandom(seed) % 64; f > 0; f--) {
+        bool frameV2 = v2 && nextRandom(seed) % 2;
+        size_t qtd = nextRandom(seed) % (frameV2 ? sizeof(payload) : MAX_DATA + 1);
+        size_t size;
+
+        if (v2 && !frameV2 && qtd == MAX_DATA) {
+            qtd--; // Com a versão 2 habilitada, QTD 0xFF é o marcador
+        }
+        for (size_t i = 0; i < qtd; i++) {
+            // Bytes especiais são frequentes para exercitar o escape
+            uint32_t r = nextRandom(seed);
+            payload[i] = r % 4 == 0 ? (uint8_t[]){STX, ETX, DLE, V2_MARKER}[(r >> 2) % 4] : (uint8_t)(r >> 8);
+        }
+        size = frameV2 ? encodeFrameV2(payload, (uint16_t)qtd, frame, escaped)
+                       : encodeFrame(payload, (uint8_t)qtd, frame, escaped);
+        switch (nextRandom(seed) % 8) {
+            case 0: // Bit trocado
+                frame[nextRandom(seed) % size] ^= (uint8_t)(1 << nextRandom(seed) % 8);
+                break;
+            case 1: // Quadro truncado
+                size = nextRandom(seed) % size;
+                break;
+            case 2: // Byte qualquer sobrescrito
+                frame[nextRandom(seed) % size] = (uint8_t)nextRandom(seed);
+                break;
+        }
+        if (n + size > capacity) {
+            break;
+        }
+        memcpy(out + n, frame, size);
+        n += size;
+        for (int g = nextRandom(seed) % 4; g > 0 && n < capacity; g--) {
+            uint32_t r = nextRandom(seed);
+            out[n++] = r % 2 ? (uint8_t)(r >> 8) : (uint8_t[]){STX, ETX, DLE, V2_MARKER}[(r >> 8) % 4];
+        }
+    }
+    free(frame);
+    return n;
+}
+
+static void saveInput(const uint8_t *data, size_t size) {
+    FILE *file = fopen("divergencia.bin", "wb");
+    if (file != NULL) {
+        fwrite(data, 1, size, file);
+        fclose(file);
+    }
+}
+
+static int check(const uint8_t *data, size_t size, const char *origin) {
+    long index;
+    const char *failed = differential(data, size, &index);
+
+    if (failed != NULL) {
+        fprintf(stderr, "divergência: %s no quadro %ld (%s, configuração 0x%02x)\n",
+                failed, index, origin, data[0]);
+        saveInput(data, size);
+        return 1;
+    }
+    return 0;
+}
+
+static uint8_t * readFile(const char *path, size_t *size) {
+    FILE *file = fopen(path, "rb");
+    uint8_t *data = NULL;
+    size_t capacity = 0;
+
+    *size = 0;
+    if (file == NULL) {
+        return NULL;
+    }
+    for (;;) {
+        if (*size == capacity) {
+            capacity = capacity ? 2 * capacity : 4096;
+            data = realloc(data, capacity);
+        }
+        size_t got = fread(data + *size, 1, capacity - *size, file);
+        if (got == 0) {
+            break;
+        }
+        *size += got;
+    }
+    fclose(file);
+    return data;
+}
+
+int main(int argc, char *argv[]) {
+    long iterations = 2000;
+    uint32_t seed = 1;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:s:")) != -1) {
+        switch (opt) {
+            case 'n': iterations = atol(optarg); break;
+            case 's': seed = (uint32_t)strtoul(optarg, NULL, 0); break;
+            default:
+                fprintf(stderr, "uso: %s [-n iterações] [-s semente] [arquivos...]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    if (optind < argc) {
+        for (int i = optind; i < argc; i++) {
+            size_t size;
+            uint8_t *data = readFile(argv[i], &size);
+            if (data == NULL) {
+                perror(argv[i]);
+                return 2;
+            }
+            int failed = check(data, size, argv[i]);
+            free(data);
+            if (failed) {
+                return 1;
+            }
+        }
+        printf("%d arquivos sem divergência\n", argc - optind);
+        return 0;
+    }
+
+    size_t capacity = 64 * FRAME_V2_SIZE(2048);
+    uint8_t *stream = malloc(capacity);
+    if (seed == 0) {
+        seed = 1; // xorshift não sai do zero
+    }
+    for (long i = 0; i < iterations; i++) {
+        size_t size = buildStream(&seed, stream, capacity);
+        char origin[32];
+        snprintf(origin, sizeof(origin), "iteração %ld", i);
+        if (check(stream, size, origin)) {
+            free(stream);
+            return 1;
+        }
+    }
+    free(stream);
+    printf("%ld fluxos sem divergência\n", iterations);
+    return 0;
+}
+
+#endif
@@ -0,0 +1,187 @@
+/**
+ * @file parallelDecoder.c
+ * @brief Implementação da decodificação paralela descrita em parallelDecoder.h.
+ */
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "parallelDecoder.h"
+
+#define FRAME_BATCH 64 // Descritores pedidos a decodeFrames por chamada
+
+typedef struct {
+    const uint8_t *buf;
+    size_t len;
+    size_t begin, end; // Faixa do bloco
+    size_t start;      // Ponto de sincronismo especulativo
+    FrameList frames;  // Quadros especulativos terminados dentro do bloco
+    FSM fsm;           // Estado da FSM especulativa no fim do bloco
+    bool threaded;     // Especulação em uma thread própria (senão já foi feita em série)
+} Chunk;
+
+/* Sem memória para crescer, descarta o quadro e marca a lista (os anteriores continuam nela) */
+static void appendRecord(FrameList *list, size_t end, uint16_t length, FrameStatus status) {
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity ? 2 * list->capacity : 1024;
+        FrameRecord *records = realloc(list->records, capacity * sizeof(FrameRecord));
+        if (records == NULL) {
+            list->outOfMemory = true;
+            return;
+        }
+        list->records = records;
+        list->capacity = capacity;
+    }
+    FrameRecord *record = &list->records[list->count++];
+    // Sem escape, os DADOS terminam dois bytes (CHK, ETX) antes do fim do quadro
+    record->payload = end - length - 2;
+    record->end = end;
+    record->length = length;
+    record->status = status;
+}
+
+static void appendList(FrameList *list, const FrameRecord *records, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        appendRecord(list, records[i].end, records[i].length, records[i].status);
+    }
+}
+
+/* Decodifica buf[from, to) com a FSM dada; para no primeiro quadro se single */
+static size_t decodeRange(FSM *fsm, const uint8_t *buf, size_t from, size_t to,
+                          FrameList *list, int single) {
+    Frame frames[FRAME_BATCH];
+    size_t pos = from;
+
+    while (pos < to) {
+        size_t used;
+        size_t count = decodeFrames(fsm, buf + pos, to - pos, frames,
+                                    single ? 1 : FRAME_BATCH, &used);
+        for (size_t i = 0; i < count; i++) {
+            appendRecord(list, pos + frames[i].end, frames[i].length, frames[i].status);
+        }
+        pos += used;
+        if (single && count > 0) {
+            break;
+        }
+    }
+    return pos;
+}
+
+static inline int isIdle(const FSM *fsm) {
+    return fsm->currentState == STATE_WAIT_STX || fsm->currentState >= STATE_COMPLETE;
+}
+
+/* Primeiro STX do bloco cujo QTD aponta para um ETX (consistência do quadro) */
+static size_t findSyncPoint(const uint8_t *buf, size_t len, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+        const uint8_t *stx = memchr(buf + i, STX, end - i);
+        if (stx == NULL) {
+            break;
+        }
+        i = (size_t)(stx - buf);
+        if (i + 1 < len) {
+            size_t etx = i + buf[i + 1] + 3;
+            if (etx < len && buf[etx] == ETX) {
+                return i;
+            }
+        }
+    }
+    return end;
+}
+
+static void * speculate(void *arg) {
+    Chunk *chunk = arg;
+
+    chunk->start = chunk->begin == 0 ? 0 :
+                   findSyncPoint(chunk->buf, chunk->len, chunk->begin, chunk->end);
+    resetFSM(&chunk->fsm);
+    decodeRange(&chunk->fsm, chunk->buf, chunk->start, chunk->end, &chunk->frames, 0);
+    return NULL;
+}
+
+bool decodeSequential(const uint8_t *buf, size_t len, FrameList *list) {
+    FSM fsm;
+
+    memset(list, 0, sizeof(*list));
+    resetFSM(&fsm);
+    decodeRange(&fsm, buf, 0, len, list, 0);
+    return !list->outOfMemory;
+}
+
+bool decodeParallel(const uint8_t *buf, size_t len, int threads, FrameList *list) {
+    if (threads < 1) {
+        threads = 1;
+    }
+    if ((size_t)threads > len / MAX_FRAME_SIZE + 1) {
+        threads = (int)(len / MAX_FRAME_SIZE) + 1;
+    }
+
+    Chunk *chunks = calloc((size_t)threads, sizeof(Chunk));
+    pthread_t *tids = malloc((size_t)threads * sizeof(pthread_t));
+    if (chunks == NULL || tids == NULL) {
+        free(chunks);
+        free(tids);
+        return decodeSequential(buf, len, list);
+    }
+
+    for (int k = 0; k < threads; k++) {
+        chunks[k].buf = buf;
+        chunks[k].len = len;
+        chunks[k].begin = len * k / threads;
+        chunks[k].end = len * (k + 1) / threads;
+        chunks[k].threaded = pthread_create(&tids[k], NULL, speculate, &chunks[k]) == 0;
+        if (!chunks[k].threaded) {
+            speculate(&chunks[k]); // Sem thread: especula em série
+        }
+    }
+
+    // Corrige as emendas em série, na ordem dos blocos
+    FSM fsm;
+    resetFSM(&fsm);
+    memset(list, 0, sizeof(*list));
+
+    for (int k = 0; k < threads; k++) {
+        Chunk *chunk = &chunks[k];
+        if (chunk->threaded) {
+            pthread_join(tids[k], NULL);
+        }
+
+        size_t pos = decodeRange(&fsm, buf, chunk->begin, chunk->start, list, 0);
+        size_t next = 0; // Próximo quadro especulativo ainda não comparado
+        // Lista especulativa incompleta (sem memória): o bloco é decodificado em série
+        bool usable = !chunk->frames.outOfMemory;
+        int converged = usable && chunk->start < chunk->end && isIdle(&fsm);
+
+        while (!converged && pos < chunk->end) {
+            size_t before = list->count;
+            pos = decodeRange(&fsm, buf, pos, chunk->end, list, 1);
+            if (list->count == before) {
+                break;
+            }
+            size_t end = list->records[list->count - 1].end;
+            while (next < chunk->frames.count && chunk->frames.records[next].end < end) {
+                next++;
+            }
+            if (usable && next < chunk->frames.count && chunk->frames.records[next].end == end) {
+                // Mesmo fim de quadro: as duas FSMs estão no mesmo estado daqui em diante
+                next++;
+                converged = 1;
+            }
+        }
+
+        if (converged) {
+            appendList(list, chunk->frames.records + next, chunk->frames.count - next);
+            fsm = chunk->fsm;
+        }
+        freeFrameList(&chunk->frames);
+    }
+
+    free(tids);
+    free(chunks);
+    return !list->outOfMemory;
+}
+
+void freeFrameList(FrameList *list) {
+    free(list->records);
+    memset(list, 0, sizeof(*list));
+}
@@ -0,0 +1,53 @@
+/**
+ * @file parallelDecoder.h
+ * @brief Decodificação paralela de capturas grandes (modo sem escape).
+ *
+ * O buffer é dividido em blocos, um por thread. Cada thread procura no seu bloco um ponto de
+ * sincronismo plausível (STX cujo QTD aponta para um ETX) e decodifica especulativamente a partir
+ * dele. Em seguida as emendas são corrigidas em série: a FSM "verdadeira", vinda do bloco anterior,
+ * decodifica o início do bloco até coincidir com a especulação (mesmo fim de quadro, ou FSM ociosa
+ * no ponto de sincronismo); daí em diante os quadros especulativos são aproveitados. Se não houver
+ * coincidência, o bloco inteiro é decodificado em série. O resultado é sempre idêntico ao de
+ * decodeSequential.
+ */
+#ifndef PARALLEL_DECODER_H
+#define PARALLEL_DECODER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "protocol.h"
+
+// Quadro decodificado, com posições absolutas no buffer de entrada
+typedef struct {
+    size_t payload;  // Início dos DADOS
+    size_t end;      // Posição logo após o último byte do quadro
+    uint16_t length;
+    FrameStatus status;
+} FrameRecord;
+
+// Lista de quadros decodificados (alocada por decodeSequential/decodeParallel)
+typedef struct {
+    FrameRecord *records;
+    size_t count;
+    size_t capacity;
+    bool outOfMemory;  // Faltou memória: a lista perdeu quadros
+} FrameList;
+
+/**
+ * Decodifica o buffer inteiro em uma única thread (referência). Retorna false se faltou memória
+ * para a lista (que guarda os quadros até ali).
+ */
+bool decodeSequential(const uint8_t *buf, size_t len, FrameList *list);
+
+/**
+ * Decodifica o buffer com a quantidade de threads indicada. Os blocos cujas threads não puderam
+ * ser criadas são decodificados em série; retorna false se faltou memória para a lista.
+ */
+bool decodeParallel(const uint8_t *buf, size_t len, int threads, FrameList *list);
+
+/** Libera a memória de uma lista de quadros. */
+void freeFrameList(FrameList *list);
+
+#endif // PARALLEL_DECODER_H
@@ -0,0 +1,636 @@
+/**
+ * @file protocol.c
+ * @brief Implementação de um decodificador de protocolo de comunicação usando uma Máquina de Estados Finitos (FSM).
+ *
+ * Este arquivo contém a implementação de um decodificador de protocolo de comunicação usando uma FSM.
+ * O formato do protocolo é o seguinte: (STX (1 B)|QTD (1 B)|DADOS (N B)|CHK (1 B)|ETX (1 B)).
+ * A FSM é implementada usando ponteiros de função e uma tabela de estados.
+ *
+ * A FSM transita pelos seguintes estados:
+ * - STATE_WAIT_STX: Aguardando o byte de Início de Texto (STX).
+ * - STATE_READ_QTD: Lendo o byte de quantidade (QTD).
+ * - STATE_READ_DATA: Lendo os bytes de dados.
+ * - STATE_READ_CHK: Lendo o byte de checksum (CHK).
+ * - STATE_WAIT_ETX: Aguardando o byte de Fim de Texto (ETX).
+ * - STATE_READ_LEN_HI/STATE_READ_LEN_LO: Lendo o LEN de 16 bits (versão 2).
+ * - STATE_READ_CRC_HI/STATE_READ_CRC_LO: Lendo o CRC-16 (versão 2).
+ * - STATE_COMPLETE: Mensagem completa recebida com sucesso.
+ * - STATE_ERROR: Ocorreu um erro durante a recepção da mensagem.
+ *
+ * A FSM é resetada para o estado inicial (STATE_WAIT_STX) após processar uma mensagem completa ou encontrar um erro;
+ * o byte que provoca o reset é processado normalmente, de modo que quadros consecutivos não se perdem.
+ *
+ * As seguintes funções lidam com os diferentes estados da FSM:
+ * - handleWaitSTX: Lida com o estado STATE_WAIT_STX.
+ * - handleReadQTD: Lida com o estado STATE_READ_QTD.
+ * - handleReadData: Lida com o estado STATE_READ_DATA.
+ * - handleReadCHK: Lida com o estado STATE_READ_CHK.
+ * - handleWaitETX: Lida com o estado STATE_WAIT_ETX.
+ * - handleReadLenHi, handleReadLenLo, handleReadCrcHi, handleReadCrcLo: Estados da versão 2.
+ *
+ * A função processByte processa cada byte da mensagem de entrada e atualiza o estado da FSM de acordo.
+ * A função processBuffer faz o mesmo para um bloco de bytes, copiando os DADOS em bloco.
+ * A função decodeFrames entrega descritores que apontam para os DADOS no próprio buffer de entrada,
+ * copiando apenas os quadros que atravessam a fronteira entre dois buffers.
+ *
+ * No modo com escape, os bytes especiais (STX, ETX, DLE) dentro do quadro são precedidos por DLE e
+ * transmitidos como byte ^ DLE_XOR. O caminho em bloco localiza trechos sem bytes especiais testando
+ * 8 bytes por vez (SWAR) e os copia com memcpy, evitando um desvio por byte.
+ *
+ * Com PROTOCOL_STATS, as macros STATS_* contam os resultados dos quadros e os ciclos gastos por
+ * estado; sem a opção elas se expandem para nada.
+ */
+#include <string.h>
+
+#include "protocol.h"
+#include "crc16.h"
+
+#ifdef PROTOCOL_STATS
+#include "cycleCounter.h"
+
+#define STATS_ENABLED            true
+#define STATS_ADD(fsm, field, n) ((fsm)->stats.field += (n))
+#define STATS_FRAME(fsm, status) ((fsm)->stats.frames[status]++)
+#define STATS_TIME_BEGIN()       uint32_t statsStart = cycleCounter()
+#define STATS_TIME_END(fsm, state, bytes)                                             \
+    do {                                                                              \
+        (fsm)->stats.stateCycles[state] += cycleCounterElapsed(statsStart, cycleCounter()); \
+        (fsm)->stats.stateBytes[state] += (bytes);                                    \
+    } while (0)
+#else
+#define STATS_ENABLED                     false
+#define STATS_ADD(fsm, field, n)          ((void)0)
+#define STATS_FRAME(fsm, status)          ((void)0)
+#define STATS_TIME_BEGIN()                ((void)0)
+#define STATS_TIME_END(fsm, state, bytes) ((void)0)
+#endif
+
+typedef bool (*StateHandler)(FSM *fsm, uint8_t byte);
+
+static bool handleWaitSTX(FSM *fsm, uint8_t byte);
+static bool handleReadQTD(FSM *fsm, uint8_t byte);
+static bool handleReadData(FSM *fsm, uint8_t byte);
+static bool handleReadCHK(FSM *fsm, uint8_t byte);
+static bool handleWaitETX(FSM *fsm, uint8_t byte);
+static bool handleReadLenHi(FSM *fsm, uint8_t byte);
+static bool handleReadLenLo(FSM *fsm, uint8_t byte);
+static bool handleReadCrcHi(FSM *fsm, uint8_t byte);
+static bool handleReadCrcLo(FSM *fsm, uint8_t byte);
+
+static const StateHandler stateTable[] = {
+    handleWaitSTX,
+    handleReadQTD,
+    handleReadData,
+    handleReadCHK,
+    handleWaitETX,
+    handleReadLenHi,
+    handleReadLenLo,
+    handleReadCrcHi,
+    handleReadCrcLo
+};
+
+// Bytes que precisam de escape no modo com byte-stuffing
+static const bool specialByte[256] = {
+    [STX] = true,
+    [ETX] = true,
+    [DLE] = true
+};
+
+// Prepara a FSM para um novo quadro, preservando a configuração
+static void restartFrame(FSM *fsm) {
+    fsm->currentState = STATE_WAIT_STX;
+    fsm->qtd = 0;
+    fsm->chk = 0;
+    fsm->dataIndex = 0;
+    fsm->version = 1;
+    fsm->crc = 0;
+    fsm->dlePending = false;
+}
+
+void resetFSM(FSM *fsm) {
+    restartFrame(fsm);
+    fsm->escaped = false;
+    fsm->v2Enabled = false;
+    fsm->v2Buffer = NULL;
+    fsm->v2Capacity = 0;
+    fsm->gapLimit = 0;
+    fsm->lastByte = 0;
+    fsm->dispatcher = NULL;
+#ifdef PROTOCOL_STATS
+    cycleCounterInit();
+    clearStats(fsm);
+#endif
+}
+
+#ifdef PROTOCOL_STATS
+void getStats(const FSM *fsm, ProtocolStats *snapshot) {
+    *snapshot = fsm->stats;
+}
+
+void clearStats(FSM *fsm) {
+    memset(&fsm->stats, 0, sizeof(fsm->stats));
+}
+#endif
+
+void setEscapedMode(FSM *fsm, bool escaped) {
+    restartFrame(fsm);
+    fsm->escaped = escaped;
+}
+
+void enableProtocolV2(FSM *fsm, uint8_t *buffer, uint16_t capacity) {
+    restartFrame(fsm);
+    fsm->v2Enabled = true;
+    fsm->v2Buffer = buffer;
+    fsm->v2Capacity = buffer ? capacity : 0;
+}
+
+static void ignoreFrame(void *context, const uint8_t *payload, uint16_t length) {
+    (void)context;
+    (void)payload;
+    (void)length;
+}
+
+void initDispatcher(Dispatcher *dispatcher, FrameHandler fallback, void *context) {
+    HandlerEntry entry = {fallback ? fallback : ignoreFrame, context};
+
+    for (int type = 0; type < 256; type++) {
+        dispatcher->types[type] = entry;
+    }
+    dispatcher->empty = entry;
+}
+
+void registerHandler(Dispatcher *dispatcher, uint8_t type, FrameHandler handler, void *context) {
+    dispatcher->types[type].handler = handler ? handler : ignoreFrame;
+    dispatcher->types[type].context = context;
+}
+
+void setDispatcher(FSM *fsm, const Dispatcher *dispatcher) {
+    fsm->dispatcher = dispatcher;
+}
+
+// Entrega um quadro correto ao tratador do seu tipo (sem testes além do quadro vazio)
+static inline void dispatchFrame(const Dispatcher *dispatcher, const uint8_t *payload, uint16_t length) {
+    const HandlerEntry *entry = length ? &dispatcher->types[payload[0]] : &dispatcher->empty;
+    entry->handler(entry->context, payload, length);
+}
+
+const uint8_t * frameData(const FSM *fsm) {
+    return fsm->version == 2 ? fsm->v2Buffer : fsm->data;
+}
+
+// Destino dos DADOS copiados; NULL se o quadro v2 não cabe no buffer configurado
+static inline uint8_t * copyDestination(FSM *fsm) {
+    if (fsm->version == 2 && fsm->qtd > fsm->v2Capacity) {
+        return NULL;
+    }
+    return fsm->version == 2 ? fsm->v2Buffer : fsm->data;
+}
+
+static bool frameTooLong(FSM *fsm) {
+    fsm->currentState = STATE_ERROR;
+    fsm->error = FRAME_BAD_LENGTH;
+    STATS_FRAME(fsm, FRAME_BAD_LENGTH);
+    return false;
+}
+
+// CRC parcial do campo LEN (o CRC v2 cobre LEN e DADOS)
+static uint16_t lengthCrc(uint16_t len) {
+    const uint8_t field[2] = {(uint8_t)(len >> 8), (uint8_t)len};
+    return crc16Update(CRC16_INIT, field, sizeof(field));
+}
+
+// Estado após o último byte de DADOS
+static inline State afterData(const FSM *fsm) {
+    return fsm->version == 2 ? STATE_READ_CRC_HI : STATE_READ_CHK;
+}
+
+static bool handleWaitSTX(FSM *fsm, uint8_t byte) {
+    if (byte == STX) {
+        fsm->currentState = STATE_READ_QTD;
+    } else {
+        STATS_ADD(fsm, discarded, 1);
+    }
+    return false;
+}
+
+static bool handleReadQTD(FSM *fsm, uint8_t byte) {
+    if (byte == V2_MARKER && fsm->v2Enabled) {
+        fsm->version = 2;
+        fsm->currentState = STATE_READ_LEN_HI;
+        return false;
+    }
+    fsm->qtd = byte;
+    // Quadro sem dados segue direto para o CHK
+    fsm->currentState = byte ? STATE_READ_DATA : STATE_READ_CHK;
+    return false;
+}
+
+static bool handleReadData(FSM *fsm, uint8_t byte) {
+    uint8_t *dest = copyDestination(fsm);
+    if (dest == NULL) {
+        return frameTooLong(fsm);
+    }
+    dest[fsm->dataIndex++] = byte;
+    if (fsm->dataIndex == fsm->qtd) {
+        fsm->currentState = afterData(fsm);
+    }
+    return false;
+}
+
+static bool handleReadCHK(FSM *fsm, uint8_t byte) {
+    fsm->chk = byte;
+    fsm->currentState = STATE_WAIT_ETX;
+    return false;
+}
+
+static bool handleWaitETX(FSM *fsm, uint8_t byte) {
+    if (byte == ETX) {
+        fsm->currentState = STATE_COMPLETE;
+        // CHK/CRC calculado uma vez, e só se as estatísticas ou o despacho usam o resultado
+        bool valid = (STATS_ENABLED || fsm->dispatcher != NULL) && checksumOk(fsm);
+        STATS_FRAME(fsm, valid ? FRAME_OK : FRAME_BAD_CHECKSUM);
+        if (fsm->dispatcher != NULL && valid) {
+            dispatchFrame(fsm->dispatcher, frameData(fsm), fsm->qtd);
+        }
+        return true;
+    } else {
+        fsm->currentState = STATE_ERROR;
+        fsm->error = FRAME_BAD_ETX;
+        STATS_FRAME(fsm, FRAME_BAD_ETX);
+    }
+    return false;
+}
+
+static bool handleReadLenHi(FSM *fsm, uint8_t byte) {
+    fsm->qtd = (uint16_t)(byte << 8);
+    fsm->currentState = STATE_READ_LEN_LO;
+    return false;
+}
+
+static bool handleReadLenLo(FSM *fsm, uint8_t byte) {
+    fsm->qtd |= byte;
+    fsm->currentState = fsm->qtd ? STATE_READ_DATA : STATE_READ_CRC_HI;
+    return false;
+}
+
+static bool handleReadCrcHi(FSM *fsm, uint8_t byte) {
+    fsm->crc = (uint16_t)(byte << 8);
+    fsm->currentState = STATE_READ_CRC_LO;
+    return false;
+}
+
+static bool handleReadCrcLo(FSM *fsm, uint8_t byte) {
+    fsm->crc |= byte;
+    fsm->currentState = STATE_WAIT_ETX;
+    return false;
+}
+
+// Trata os delimitadores e o DLE antes da tabela de estados (modo com escape)
+static bool processEscapedByte(FSM *fsm, uint8_t byte) {
+    if (byte == STX) {
+        // STX cru sempre inicia um novo quadro
+        if (fsm->currentState != STATE_WAIT_STX) {
+            STATS_ADD(fsm, resyncs, 1);
+        }
+        restartFrame(fsm);
+        fsm->currentState = STATE_READ_QTD;
+        return false;
+    }
+    switch (fsm->currentState) {
+        case STATE_WAIT_STX:
+            STATS_ADD(fsm, discarded, 1);
+            return false;
+        case STATE_WAIT_ETX:
+            return handleWaitETX(fsm, byte);
+        default:
+            break;
+    }
+    if (byte == ETX) {
+        // ETX cru antes do fim: quadro truncado
+        fsm->currentState = STATE_ERROR;
+        fsm->error = FRAME_BAD_LENGTH;
+        STATS_FRAME(fsm, FRAME_BAD_LENGTH);
+        return false;
+    }
+    if (byte == DLE) {
+        fsm->dlePending = true;
+        return false;
+    }
+    if (fsm->dlePending) {
+        fsm->dlePending = false;
+        byte ^= DLE_XOR;
+    }
+    return stateTable[fsm->currentState](fsm, byte);
+}
+
+void setGapTimeout(FSM *fsm, uint32_t limit) {
+    fsm->gapLimit = limit;
+}
+
+bool checkTimeout(FSM *fsm, uint32_t now) {
+    State state = fsm->currentState;
+    if (fsm->gapLimit == 0 || state == STATE_WAIT_STX || state >= STATE_COMPLETE) {
+        return false;
+    }
+    if (now - fsm->lastByte <= fsm->gapLimit) {
+        return false;
+    }
+    fsm->currentState = STATE_ERROR;
+    fsm->error = FRAME_TIMEOUT;
+    STATS_FRAME(fsm, FRAME_TIMEOUT);
+    return true;
+}
+
+bool bytesReceivedAt(FSM *fsm, uint32_t now) {
+    bool aborted = checkTimeout(fsm, now);
+    fsm->lastByte = now;
+    return aborted;
+}
+
+bool processByteAt(FSM *fsm, uint8_t byte, uint32_t now) {
+    bytesReceivedAt(fsm, now);
+    return processByte(fsm, byte);
+}
+
+bool processByte(FSM *fsm, uint8_t byte) {
+    bool complete;
+
+    if (fsm->currentState >= STATE_COMPLETE) {
+        restartFrame(fsm);
+    }
+    STATS_TIME_BEGIN();
+#ifdef PROTOCOL_STATS
+    State state = fsm->currentState;
+#endif
+    if (fsm->escaped) {
+        complete = processEscapedByte(fsm, byte);
+    } else {
+        complete = stateTable[fsm->currentState](fsm, byte);
+    }
+    STATS_TIME_END(fsm, state, 1);
+    return complete;
+}
+
+// Retorna uma palavra com o bit 7 ligado em cada byte de w igual a b
+static inline uint64_t matchByte(uint64_t w, uint8_t b) {
+    uint64_t x = w ^ (0x0101010101010101ULL * b);
+    return (x - 0x0101010101010101ULL) & ~x & 0x8080808080808080ULL;
+}
+
+// Comprimento do maior prefixo de p sem bytes especiais
+static size_t plainRunLength(const uint8_t *p, size_t n) {
+    size_t i = 0;
+    while (i + 8 <= n) {
+        uint64_t w;
+        memcpy(&w, p + i, sizeof(w));
+        if (matchByte(w, STX) | matchByte(w, ETX) | matchByte(w, DLE)) {
+            break;
+        }
+        i += 8;
+    }
+    while (i < n && !specialByte[p[i]]) {
+        i++;
+    }
+    return i;
+}
+
+// Copia em bloco o maior trecho de DADOS disponível em buf (estado STATE_READ_DATA)
+static size_t copyDataRun(FSM *fsm, const uint8_t *buf, size_t len) {
+    STATS_TIME_BEGIN();
+    uint8_t *dest = copyDestination(fsm);
+    if (dest == NULL) {
+        if (fsm->escaped && plainRunLength(buf, 1) == 0) {
+            return 0; // DLE, STX ou ETX: processByte decide se é um byte de DADOS
+        }
+        // Consome o byte que excedeu, como handleReadData
+        frameTooLong(fsm);
+        return 1;
+    }
+    size_t n = (size_t)(fsm->qtd - fsm->dataIndex);
+    if (n > len) {
+        n = len;
+    }
+    if (fsm->escaped) {
+        n = plainRunLength(buf, n);
+    }
+    memcpy(dest + fsm->dataIndex, buf, n);
+    fsm->dataIndex += (uint16_t)n;
+    if (fsm->dataIndex == fsm->qtd) {
+        fsm->currentState = afterData(fsm);
+    }
+    STATS_TIME_END(fsm, STATE_READ_DATA, n);
+    return n;
+}
+
+static inline bool frameEnded(const FSM *fsm) {
+    return fsm->currentState >= STATE_COMPLETE;
+}
+
+size_t processBuffer(FSM *fsm, const uint8_t *buf, size_t len, bool *complete) {
+    size_t i = 0;
+
+    *complete = false;
+    while (i < len) {
+        if (fsm->currentState == STATE_READ_DATA && !fsm->dlePending) {
+            i += copyDataRun(fsm, buf + i, len - i);
+            if (i == len || frameEnded(fsm)) {
+                break;
+            }
+        }
+        *complete = processByte(fsm, buf[i++]);
+        if (frameEnded(fsm)) {
+            break;
+        }
+    }
+    return i;
+}
+
+FrameStatus frameStatus(const FSM *fsm) {
+    if (fsm->currentState == STATE_ERROR) {
+        return fsm->error;
+    }
+    return checksumOk(fsm) ? FRAME_OK : FRAME_BAD_CHECKSUM;
+}
+
+size_t decodeFrames(FSM *fsm, const uint8_t *buf, size_t len,
+                    Frame *frames, size_t maxFrames, size_t *consumed) {
+    size_t i = 0, count = 0;
+
+    while (i < len && count < maxFrames) {
+        if (!fsm->escaped) {
+            if (fsm->currentState == STATE_WAIT_STX) {
+                // Procura o próximo STX sem passar pela tabela de estados
+                STATS_TIME_BEGIN();
+                const uint8_t *stx = memchr(buf + i, STX, len - i);
+                size_t next = stx ? (size_t)(stx - buf) : len;
+                STATS_ADD(fsm, discarded, next - i);
+                STATS_TIME_END(fsm, STATE_WAIT_STX, next - i);
+                i = next;
+                if (stx == NULL) {
+                    break;
+                }
+            } else if (fsm->currentState == STATE_READ_DATA && fsm->dataIndex == 0 &&
+                       len - i >= (size_t)fsm->qtd + fsm->version + 1) {
+                // Quadro inteiro no buffer: entrega sem copiar
+                STATS_TIME_BEGIN();
+                const uint8_t *payload = buf + i;
+                const uint8_t *trailer = payload + fsm->qtd; // CHK ou CRC, seguido do ETX
+                size_t size = (size_t)fsm->qtd + fsm->version + 1;
+                Frame *frame = &frames[count++];
+                bool valid;
+                if (fsm->version == 2) {
+                    fsm->crc = (uint16_t)(trailer[0] << 8 | trailer[1]);
+                    valid = crc16Update(lengthCrc(fsm->qtd), payload, fsm->qtd) == fsm->crc;
+                } else {
+                    fsm->chk = trailer[0];
+                    valid = computeChecksum(payload, fsm->qtd) == fsm->chk;
+                }
+                if (payload[size - 1] != ETX) {
+                    fsm->currentState = STATE_ERROR;
+                    frame->status = fsm->error = FRAME_BAD_ETX;
+                } else {
+                    fsm->currentState = STATE_COMPLETE;
+                    frame->status = valid ? FRAME_OK : FRAME_BAD_CHECKSUM;
+                }
+                i += size;
+                frame->payload = payload;
+                frame->length = fsm->qtd;
+                frame->version = fsm->version;
+                frame->end = i;
+                frame->copied = false;
+                STATS_FRAME(fsm, frame->status);
+                STATS_TIME_END(fsm, STATE_READ_DATA, size);
+                if (fsm->dispatcher != NULL && frame->status == FRAME_OK) {
+                    dispatchFrame(fsm->dispatcher, payload, fsm->qtd);
+                }
+                continue;
+            }
+        }
+        bool ended = false;
+        if (fsm->currentState == STATE_READ_DATA && !fsm->dlePending) {
+            // Quadro que atravessa a fronteira dos buffers: copia
+            size_t n = copyDataRun(fsm, buf + i, len - i);
+            i += n;
+            // DADOS v2 maiores que v2Capacity terminam o quadro com FRAME_BAD_LENGTH
+            ended = frameEnded(fsm);
+            if (n > 0 && !ended) {
+                continue;
+            }
+        }
+        if (!ended) {
+            processByte(fsm, buf[i++]);
+            ended = frameEnded(fsm);
+        }
+        if (ended) {
+            Frame *frame = &frames[count++];
+            frame->payload = frameData(fsm);
+            frame->length = fsm->currentState == STATE_COMPLETE ? fsm->qtd : fsm->dataIndex;
+            frame->version = fsm->version;
+            frame->status = frameStatus(fsm);
+            frame->end = i;
+            frame->copied = true;
+            if (frame->length > 0) {
+                break; // O próximo quadro sobrescreveria os dados copiados
+            }
+        }
+    }
+    *consumed = i;
+    return count;
+}
+
+uint8_t computeChecksum(const uint8_t *data, size_t len) {
+    uint64_t acc = 0;
+    size_t i = 0;
+
+    // XOR de 8 bytes por vez, dobrado em um byte no final
+    for (; i + 8 <= len; i += 8) {
+        uint64_t w;
+        memcpy(&w, data + i, sizeof(w));
+        acc ^= w;
+    }
+    acc ^= acc >> 32;
+    acc ^= acc >> 16;
+    acc ^= acc >> 8;
+
+    uint8_t chk = (uint8_t)acc;
+    for (; i < len; i++) {
+        chk ^= data[i];
+    }
+    return chk;
+}
+
+bool checksumOk(const FSM *fsm) {
+    if (fsm->version == 2) {
+        return crc16Update(lengthCrc(fsm->qtd), fsm->v2Buffer, fsm->qtd) == fsm->crc;
+    }
+    return computeChecksum(fsm->data, fsm->qtd) == fsm->chk;
+}
+
+// Escreve um byte de campo, escapando-o se necessário
+static size_t putEscaped(uint8_t *out, uint8_t byte) {
+    if (specialByte[byte]) {
+        out[0] = DLE;
+        out[1] = byte ^ DLE_XOR;
+        return 2;
+    }
+    out[0] = byte;
+    return 1;
+}
+
+// Escreve um bloco de DADOS, escapando os bytes especiais em trechos
+static size_t putEscapedBlock(uint8_t *out, const uint8_t *data, size_t len) {
+    size_t n = 0;
+    for (size_t i = 0; i < len; ) {
+        size_t run = plainRunLength(data + i, len - i);
+        memcpy(out + n, data + i, run);
+        n += run;
+        i += run;
+        if (i < len) {
+            n += putEscaped(out + n, data[i++]);
+        }
+    }
+    return n;
+}
+
+size_t encodeFrame(const uint8_t *payload, uint8_t len, uint8_t *out, bool escaped) {
+    uint8_t chk = computeChecksum(payload, len);
+    size_t n = 0;
+
+    out[n++] = STX;
+    if (!escaped) {
+        out[n++] = len;
+        memcpy(out + n, payload, len);
+        n += len;
+        out[n++] = chk;
+        out[n++] = ETX;
+        return n;
+    }
+
+    n += putEscaped(out + n, len);
+    n += putEscapedBlock(out + n, payload, len);
+    n += putEscaped(out + n, chk);
+    out[n++] = ETX;
+    return n;
+}
+
+size_t encodeFrameV2(const uint8_t *payload, uint16_t len, uint8_t *out, bool escaped) {
+    const uint8_t header[2] = {(uint8_t)(len >> 8), (uint8_t)len};
+    uint16_t crc = crc16Update(lengthCrc(len), payload, len);
+    const uint8_t trailer[2] = {(uint8_t)(crc >> 8), (uint8_t)crc};
+    size_t n = 0;
+
+    out[n++] = STX;
+    out[n++] = V2_MARKER;
+    if (!escaped) {
+        memcpy(out + n, header, 2);
+        memcpy(out + n + 2, payload, len);
+        memcpy(out + n + 2 + len, trailer, 2);
+        n += (size_t)len + 4;
+    } else {
+        n += putEscapedBlock(out + n, header, 2);
+        n += putEscapedBlock(out + n, payload, len);
+        n += putEscapedBlock(out + n, trailer, 2);
+    }
+    out[n++] = ETX;
+    return n;
+}
@@ -0,0 +1,262 @@
+/**
+ * @file protocol.h
+ * @brief Interface do decodificador/codificador do protocolo de comunicação.
+ *
+ * Formato do quadro: (STX (1 B)|QTD (1 B)|DADOS (N B)|CHK (1 B)|ETX (1 B)).
+ * O CHK é o XOR de todos os bytes de DADOS.
+ *
+ * No modo com escape (byte-stuffing estilo DLE) os campos QTD, DADOS e CHK
+ * são transmitidos com os bytes STX, ETX e DLE substituídos pela sequência
+ * (DLE, byte ^ DLE_XOR). Assim, STX e ETX "crus" só aparecem como
+ * delimitadores e o decodificador se ressincroniza em qualquer STX recebido,
+ * mesmo no meio de um quadro corrompido.
+ *
+ * Compilando com -DPROTOCOL_STATS, a FSM mantém contadores de quadros por resultado, de bytes
+ * descartados na procura do STX e de ciclos gastos em cada estado (ver ProtocolStats). Sem a
+ * opção, a instrumentação não gera código algum.
+ *
+ * Opcionalmente a FSM detecta silêncio na linha (como o t3.5 do Modbus RTU): com um limite
+ * configurado por setGapTimeout, um quadro parcial é abandonado quando o intervalo entre dois
+ * bytes excede o limite, em vez de ser completado por bytes de quadros posteriores. O tempo é
+ * informado pelo chamador em qualquer unidade (ticks, µs), com aritmética módulo 2^32.
+ *
+ * Versão 2 do quadro, para cargas grandes:
+ * (STX (1 B)|V2_MARKER (1 B)|LEN (2 B, big-endian)|DADOS (LEN B)|CRC (2 B, big-endian)|ETX (1 B)).
+ * O CRC é o CRC-16/CCITT (crc16.h) de LEN e DADOS. Com enableProtocolV2, a FSM reconhece a
+ * versão pelo byte após o STX: V2_MARKER seleciona a versão 2 e qualquer outro valor é o QTD de
+ * um quadro da versão 1. Por isso, com a versão 2 habilitada, quadros v1 levam no máximo
+ * MAX_DATA - 1 bytes; sem ela, o comportamento da versão 1 não muda.
+ *
+ * Despacho de quadros: com setDispatcher, cada quadro completo com CHK/CRC correto é entregue
+ * diretamente, no caminho de conclusão do decodificador, ao tratador registrado para o seu
+ * primeiro byte de DADOS (o tipo da mensagem). A tabela tem uma entrada por tipo, preenchida na
+ * inicialização, e o despacho é uma indexação seguida de uma chamada indireta.
+ */
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define STX     0x02 // Início do quadro
+#define ETX     0x03 // Fim do quadro
+#define DLE     0x10 // Prefixo de escape
+#define DLE_XOR 0x20 // Máscara aplicada ao byte escapado
+
+#define MAX_DATA 255 // Tamanho máximo de DADOS (QTD tem 1 byte)
+
+#define V2_MARKER   0xFF   // Byte após o STX que identifica a versão 2
+#define MAX_DATA_V2 0xFFFF // Tamanho máximo de DADOS na versão 2
+
+// Tamanho máximo de um quadro codificado: no pior caso QTD, DADOS e CHK
+// são todos escapados (2 bytes cada).
+#define MAX_FRAME_SIZE (2 + 2 * (MAX_DATA + 2))
+
+// Tamanho máximo de um quadro v2 codificado com len bytes de DADOS
+#define FRAME_V2_SIZE(len) (3 + 2 * ((size_t)(len) + 4))
+
+typedef enum {
+    STATE_WAIT_STX,
+    STATE_READ_QTD,
+    STATE_READ_DATA,
+    STATE_READ_CHK,
+    STATE_WAIT_ETX,
+    STATE_READ_LEN_HI, // Versão 2: byte alto de LEN
+    STATE_READ_LEN_LO, // Versão 2: byte baixo de LEN
+    STATE_READ_CRC_HI, // Versão 2: byte alto do CRC
+    STATE_READ_CRC_LO, // Versão 2: byte baixo do CRC
+    STATE_COMPLETE,
+    STATE_ERROR
+} State;
+
+// Resultado de um quadro terminado (completo ou com erro)
+typedef enum {
+    FRAME_OK,           // Quadro completo com CHK correto
+    FRAME_BAD_CHECKSUM, // Quadro completo com CHK incorreto
+    FRAME_BAD_ETX,      // Byte após o CHK não era ETX
+    FRAME_BAD_LENGTH,   // ETX cru antes do fim dos DADOS (modo com escape) ou LEN maior que o buffer v2
+    FRAME_TIMEOUT,      // Intervalo entre bytes excedeu o limite (setGapTimeout)
+    FRAME_STATUS_COUNT
+} FrameStatus;
+
+#ifdef PROTOCOL_STATS
+// Estatísticas do decodificador
+typedef struct {
+    uint32_t frames[FRAME_STATUS_COUNT];   // Quadros terminados, por FrameStatus
+    uint32_t resyncs;                      // Quadros abandonados por um STX cru (modo com escape)
+    uint32_t discarded;                    // Bytes descartados procurando o STX
+    uint64_t stateCycles[STATE_COMPLETE];  // Ciclos gastos em cada estado (cycleCounter.h)
+    uint32_t stateBytes[STATE_COMPLETE];   // Bytes processados em cada estado
+} ProtocolStats;
+#endif
+
+/**
+ * Tratador de mensagem: recebe os DADOS do quadro, incluindo o byte de tipo. payload só é válido
+ * durante a chamada (pode apontar para o buffer do chamador ou para a FSM). O tratador não pode
+ * processar bytes na mesma FSM.
+ */
+typedef void (*FrameHandler)(void *context, const uint8_t *payload, uint16_t length);
+
+typedef struct {
+    FrameHandler handler;
+    void *context;
+} HandlerEntry;
+
+// Tabela de tratadores indexada pelo primeiro byte de DADOS
+typedef struct {
+    HandlerEntry types[256];
+    HandlerEntry empty;   // Quadros sem DADOS
+} Dispatcher;
+
+typedef struct {
+    State currentState;
+    uint16_t qtd;         // QTD (v1) ou LEN (v2)
+    uint8_t data[256];
+    uint8_t chk;
+    uint16_t dataIndex;
+    uint8_t version;      // Versão do quadro em recepção (1 ou 2)
+    uint16_t crc;         // CRC recebido (v2)
+    uint8_t *v2Buffer;    // Destino dos DADOS copiados de quadros v2
+    uint16_t v2Capacity;  // Tamanho de v2Buffer
+    bool v2Enabled;       // Reconhece quadros da versão 2
+    bool escaped;         // Modo com byte-stuffing habilitado
+    bool dlePending;      // Último byte recebido foi um DLE
+    FrameStatus error;    // Motivo do erro (válido em STATE_ERROR)
+    uint32_t gapLimit;    // Intervalo máximo entre bytes de um quadro (0 = sem limite)
+    uint32_t lastByte;    // Instante do último byte recebido
+    const Dispatcher *dispatcher; // Tratadores de mensagem (NULL = sem despacho)
+#ifdef PROTOCOL_STATS
+    ProtocolStats stats;
+#endif
+} FSM;
+
+/**
+ * Descritor de um quadro entregue por decodeFrames. Quando o quadro está
+ * inteiro no buffer do chamador, payload aponta para dentro dele (sem
+ * cópia); quando atravessa a fronteira entre dois buffers (ou no modo com
+ * escape), os dados são copiados em fsm->data (v2Buffer na versão 2) e
+ * copied é true.
+ */
+typedef struct {
+    const uint8_t *payload; // Início dos DADOS
+    size_t end;             // Posição no buffer logo após o último byte do quadro
+    uint16_t length;        // Quantidade de DADOS
+    uint8_t version;        // Versão do quadro (1 ou 2)
+    FrameStatus status;
+    bool copied;            // payload aponta para fsm->data/v2Buffer
+} Frame;
+
+/** Reinicia a FSM no modo sem escape. */
+void resetFSM(FSM *fsm);
+
+/** Habilita ou desabilita o modo com escape (byte-stuffing). */
+void setEscapedMode(FSM *fsm, bool escaped);
+
+/**
+ * Habilita o reconhecimento de quadros da versão 2. Os DADOS de quadros v2 que precisam ser
+ * copiados (byte a byte, em bloco, atravessando buffers ou com escape) vão para buffer, de
+ * capacity bytes; quadros maiores terminam com FRAME_BAD_LENGTH. buffer pode ser NULL se a
+ * aplicação só usa decodeFrames com quadros inteiros no buffer de entrada.
+ */
+void enableProtocolV2(FSM *fsm, uint8_t *buffer, uint16_t capacity);
+
+/**
+ * Inicializa a tabela de despacho: todos os tipos (e os quadros sem DADOS) vão para fallback,
+ * que pode ser NULL para ignorá-los.
+ */
+void initDispatcher(Dispatcher *dispatcher, FrameHandler fallback, void *context);
+
+/** Registra o tratador das mensagens do tipo dado (primeiro byte de DADOS). */
+void registerHandler(Dispatcher *dispatcher, uint8_t type, FrameHandler handler, void *context);
+
+/**
+ * Associa a tabela de despacho à FSM (NULL desabilita). processByte, processBuffer e decodeFrames
+ * passam a chamar o tratador de cada quadro completo com CHK/CRC correto; decodeFrames continua
+ * entregando os descritores. A tabela não é copiada e deve permanecer válida.
+ */
+void setDispatcher(FSM *fsm, const Dispatcher *dispatcher);
+
+/** Configura o intervalo máximo entre bytes de um quadro (0 desabilita). */
+void setGapTimeout(FSM *fsm, uint32_t limit);
+
+/**
+ * Verifica o intervalo desde o último byte sem consumir bytes (chamada periódica, por exemplo
+ * de um tick). Se o limite foi excedido no meio de um quadro, abandona-o (STATE_ERROR com
+ * FRAME_TIMEOUT) e retorna true.
+ */
+bool checkTimeout(FSM *fsm, uint32_t now);
+
+/**
+ * Informa a chegada de bytes no instante now: aplica checkTimeout e registra o instante.
+ * Deve ser chamada antes de processBuffer/decodeFrames para cada bloco recebido.
+ * Retorna true se um quadro parcial foi abandonado.
+ */
+bool bytesReceivedAt(FSM *fsm, uint32_t now);
+
+/** Igual a processByte, para um byte recebido no instante now. */
+bool processByteAt(FSM *fsm, uint8_t byte, uint32_t now);
+
+/**
+ * Processa um byte. Retorna true quando um quadro completo foi recebido;
+ * os dados ficam em frameData(fsm) até o próximo byte ser processado.
+ */
+bool processByte(FSM *fsm, uint8_t byte);
+
+/**
+ * Processa um bloco de bytes, copiando trechos de DADOS em bloco.
+ * Retorna a quantidade de bytes consumidos: o processamento para logo após
+ * o fim de um quadro (completo ou com erro). Quadros completos são
+ * sinalizados em *complete.
+ */
+size_t processBuffer(FSM *fsm, const uint8_t *buf, size_t len, bool *complete);
+
+/**
+ * Decodifica um bloco contíguo entregando descritores de quadro sem copiar
+ * os DADOS (ver Frame). Quadros com erro também geram descritores.
+ * Para após maxFrames quadros ou no fim do bloco e informa em *consumed
+ * quantos bytes foram usados. Descritores com copied == true só são válidos
+ * até a próxima chamada, por isso cada chamada entrega no máximo um quadro
+ * copiado com dados (sempre o último descritor).
+ * Retorna a quantidade de descritores preenchidos.
+ */
+size_t decodeFrames(FSM *fsm, const uint8_t *buf, size_t len,
+                    Frame *frames, size_t maxFrames, size_t *consumed);
+
+/** Resultado do quadro terminado por processByte/processBuffer (STATE_COMPLETE ou STATE_ERROR). */
+FrameStatus frameStatus(const FSM *fsm);
+
+#ifdef PROTOCOL_STATS
+/**
+ * Copia as estatísticas da FSM (uma cópia de estrutura, barata o bastante para uma tarefa de
+ * monitoramento). Se a FSM roda em outra tarefa/interrupção, a cópia pode misturar contadores
+ * de antes e depois de um byte, mas cada contador individual é consistente.
+ */
+void getStats(const FSM *fsm, ProtocolStats *snapshot);
+
+/** Zera as estatísticas da FSM (resetFSM também as zera). */
+void clearStats(FSM *fsm);
+#endif
+
+/** DADOS do quadro recebido por processByte/processBuffer (fsm->data ou v2Buffer). */
+const uint8_t * frameData(const FSM *fsm);
+
+/** Calcula o CHK (XOR) de um bloco de dados. */
+uint8_t computeChecksum(const uint8_t *data, size_t len);
+
+/** Verifica se o CHK (v1) ou CRC (v2) do quadro recebido confere com os dados. */
+bool checksumOk(const FSM *fsm);
+
+/**
+ * Codifica um quadro em out (que deve ter ao menos MAX_FRAME_SIZE bytes).
+ * Retorna o tamanho do quadro codificado.
+ */
+size_t encodeFrame(const uint8_t *payload, uint8_t len, uint8_t *out, bool escaped);
+
+/**
+ * Codifica um quadro da versão 2 em out (que deve ter ao menos FRAME_V2_SIZE(len) bytes).
+ * Retorna o tamanho do quadro codificado.
+ */
+size_t encodeFrameV2(const uint8_t *payload, uint16_t len, uint8_t *out, bool escaped);
+
+#endif // PROTOCOL_H
@@ -0,0 +1,250 @@
+/**
+ * @file replay.c
+ * @brief Ferramenta de reprodução de capturas através do decodificador (protocol.c).
+ *
+ * Uso:
+ *   replay [-e] captura.bin
+ *       Mapeia a captura na memória (mmap, sem cópias por read()) e a decodifica com decodeFrames.
+ *       Imprime a contagem de quadros por classe de erro, a vazão e um histograma da latência
+ *       por quadro (tempo de decodificação de cada quadro, em potências de 2 de nanossegundos).
+ *
+ *   replay -g captura.bin [-e] [-n quadros] [-s min:max] [-d uniforme|fixo|bimodal]
+ *          [-r erros_por_byte] [-l lixo_por_quadro] [-S semente]
+ *       Gera uma captura sintética com a distribuição de tamanhos e o ruído indicados.
+ *
+ * A opção -e usa o modo com escape (byte-stuffing) na geração e na decodificação.
+ */
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "protocol.h"
+
+#define HIST_BUCKETS 32 // Faixas de latência: [2^k, 2^(k+1)) ns
+#define FRAME_BATCH  64
+
+typedef enum { DIST_UNIFORME, DIST_FIXO, DIST_BIMODAL } Distribution;
+
+typedef struct {
+    long frames;
+    int minSize, maxSize;
+    Distribution dist;
+    double bitErrorRate; // Probabilidade de inverter um bit em cada byte
+    double garbageRate;  // Média de bytes de lixo entre quadros
+    bool escaped;
+    unsigned seed;
+} GeneratorConfig;
+
+static const char *statusNames[] = {
+    [FRAME_OK] = "ok",
+    [FRAME_BAD_CHECKSUM] = "CHK incorreto",
+    [FRAME_BAD_ETX] = "ETX incorreto",
+    [FRAME_BAD_LENGTH] = "tamanho incorreto",
+    [FRAME_TIMEOUT] = "tempo esgotado"
+};
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static double uniform(void) {
+    return rand() / ((double)RAND_MAX + 1);
+}
+
+static int frameSize(const GeneratorConfig *cfg) {
+    int span = cfg->maxSize - cfg->minSize + 1;
+    switch (cfg->dist) {
+        case DIST_FIXO:
+            return cfg->maxSize;
+        case DIST_BIMODAL:
+            // Muitos quadros curtos (comandos) e alguns longos (dados em massa)
+            return uniform() < 0.8 ? cfg->minSize + rand() % (span / 8 + 1)
+                                   : cfg->maxSize - rand() % (span / 8 + 1);
+        default:
+            return cfg->minSize + rand() % span;
+    }
+}
+
+static int generate(const char *path, const GeneratorConfig *cfg) {
+    FILE *out = fopen(path, "wb");
+    uint8_t payload[MAX_DATA];
+    uint8_t frame[MAX_FRAME_SIZE];
+
+    if (out == NULL) {
+        perror(path);
+        return 1;
+    }
+    srand(cfg->seed);
+    for (long f = 0; f < cfg->frames; f++) {
+        int qtd = frameSize(cfg);
+        for (int i = 0; i < qtd; i++) {
+            payload[i] = (uint8_t)rand();
+        }
+        size_t n = encodeFrame(payload, (uint8_t)qtd, frame, cfg->escaped);
+        for (size_t i = 0; i < n; i++) {
+            if (uniform() < cfg->bitErrorRate) {
+                frame[i] ^= (uint8_t)(1 << (rand() % 8));
+            }
+        }
+        fwrite(frame, 1, n, out);
+        while (uniform() < cfg->garbageRate / (1 + cfg->garbageRate)) {
+            fputc(rand() & 0xff, out);
+        }
+    }
+    return fclose(out) != 0;
+}
+
+static int bucketOf(double ns) {
+    int k = 0;
+    while (k < HIST_BUCKETS - 1 && ns >= (double)(2UL << k)) {
+        k++;
+    }
+    return k;
+}
+
+static int replay(const char *path, bool escaped) {
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+
+    if (fd < 0 || fstat(fd, &st) < 0) {
+        perror(path);
+        return 1;
+    }
+    size_t len = (size_t)st.st_size;
+    if (len == 0) {
+        printf("captura vazia\n");
+        close(fd);
+        return 0;
+    }
+    const uint8_t *buf = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (buf == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    madvise((void *)buf, len, MADV_SEQUENTIAL);
+
+    // Passada 1: vazão, com descritores em lote
+    long counts[FRAME_STATUS_COUNT] = {0};
+    long total = 0;
+    size_t framed = 0; // Bytes pertencentes a quadros entregues
+    Frame frames[FRAME_BATCH];
+    FSM fsm;
+    size_t pos = 0;
+
+    resetFSM(&fsm);
+    setEscapedMode(&fsm, escaped);
+    double start = now();
+    while (pos < len) {
+        size_t used;
+        size_t count = decodeFrames(&fsm, buf + pos, len - pos, frames, FRAME_BATCH, &used);
+        for (size_t i = 0; i < count; i++) {
+            counts[frames[i].status]++;
+            framed += (size_t)frames[i].length + 4;
+        }
+        total += (long)count;
+        pos += used;
+    }
+    double elapsed = now() - start;
+
+    // Passada 2: latência de cada quadro (um descritor por chamada)
+    long histogram[HIST_BUCKETS] = {0};
+    resetFSM(&fsm);
+    setEscapedMode(&fsm, escaped);
+    pos = 0;
+    while (pos < len) {
+        size_t used;
+        double t0 = now();
+        size_t count = decodeFrames(&fsm, buf + pos, len - pos, frames, 1, &used);
+        double t1 = now();
+        if (count > 0) {
+            histogram[bucketOf((t1 - t0) * 1e9)]++;
+        }
+        pos += used;
+    }
+    munmap((void *)buf, len);
+
+    printf("arquivo: %s (%zu bytes)\n", path, len);
+    printf("quadros: %ld\n", total);
+    for (int s = FRAME_OK; s < FRAME_STATUS_COUNT; s++) {
+        printf("  %-18s %ld\n", statusNames[s], counts[s]);
+    }
+    if (!escaped) {
+        // Com escape o tamanho do quadro na linha não é derivável de length
+        printf("bytes fora de quadros: %zu\n", len > framed ? len - framed : 0);
+    }
+    printf("vazão: %.1f MB/s, %.2f Mquadros/s\n", len / elapsed / 1e6, total / elapsed / 1e6);
+    printf("latência por quadro (ns):\n");
+    for (int k = 0; k < HIST_BUCKETS; k++) {
+        if (histogram[k] > 0) {
+            printf("  [%8lu, %8lu) %ld\n", k ? 1UL << k : 0, 2UL << k, histogram[k]);
+        }
+    }
+    return 0;
+}
+
+static void usage(void) {
+    fprintf(stderr, "uso: replay [-e] captura.bin\n"
+                    "     replay -g captura.bin [-e] [-n quadros] [-s min:max]\n"
+                    "            [-d uniforme|fixo|bimodal] [-r erros_por_byte]\n"
+                    "            [-l lixo_por_quadro] [-S semente]\n");
+}
+
+int main(int argc, char *argv[]) {
+    GeneratorConfig cfg = {100000, 0, MAX_DATA, DIST_UNIFORME, 0.0, 0.0, false, 1};
+    const char *output = NULL;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "g:en:s:d:r:l:S:")) != -1) {
+        switch (opt) {
+            case 'g':
+                output = optarg;
+                break;
+            case 'e':
+                cfg.escaped = true;
+                break;
+            case 'n':
+                cfg.frames = atol(optarg);
+                break;
+            case 's':
+                if (sscanf(optarg, "%d:%d", &cfg.minSize, &cfg.maxSize) != 2 ||
+                    cfg.minSize < 0 || cfg.maxSize > MAX_DATA || cfg.minSize > cfg.maxSize) {
+                    usage();
+                    return 1;
+                }
+                break;
+            case 'd':
+                cfg.dist = strcmp(optarg, "fixo") == 0 ? DIST_FIXO :
+                           strcmp(optarg, "bimodal") == 0 ? DIST_BIMODAL : DIST_UNIFORME;
+                break;
+            case 'r':
+                cfg.bitErrorRate = atof(optarg);
+                break;
+            case 'l':
+                cfg.garbageRate = atof(optarg);
+                break;
+            case 'S':
+                cfg.seed = (unsigned)atol(optarg);
+                break;
+            default:
+                usage();
+                return 1;
+        }
+    }
+
+    if (output != NULL) {
+        return generate(output, &cfg);
+    }
+    if (optind != argc - 1) {
+        usage();
+        return 1;
+    }
+    return replay(argv[optind], cfg.escaped);
+}
@@ -1,144 +1,576 @@
 /**
  * @file transmissionProtocol.c
- * @brief Implementação de um decodificador de protocolo de comunicação usando uma Máquina de Estados Finitos (FSM).
+ * @brief Testes do decodificador de protocolo de comunicação (protocol.c).
  *
- * Este arquivo contém a implementação de um decodificador de protocolo de comunicação usando uma FSM.
- * O formato do protocolo é o seguinte: (STX (1 B)|QTD (1 B)|DADOS (N B)|CHK (1 B)|ETX (1 B)).
- * A FSM é implementada usando ponteiros de função e uma tabela de estados.
- *
- * A FSM transita pelos seguintes estados:
- * - STATE_WAIT_STX: Aguardando o byte de Início de Texto (STX).
- * - STATE_READ_QTD: Lendo o byte de quantidade (QTD).
- * - STATE_READ_DATA: Lendo os bytes de dados.
- * - STATE_READ_CHK: Lendo o byte de checksum (CHK).
- * - STATE_WAIT_ETX: Aguardando o byte de Fim de Texto (ETX).
- * - STATE_COMPLETE: Mensagem completa recebida com sucesso.
- * - STATE_ERROR: Ocorreu um erro durante a recepção da mensagem.
- *
- * A FSM é resetada para o estado inicial (STATE_WAIT_STX) após processar uma mensagem completa ou encontrar um erro.
- *
- * As seguintes funções lidam com os diferentes estados da FSM:
- * - handleWaitSTX: Lida com o estado STATE_WAIT_STX.
- * - handleReadQTD: Lida com o estado STATE_READ_QTD.
- * - handleReadData: Lida com o estado STATE_READ_DATA.
- * - handleReadCHK: Lida com o estado STATE_READ_CHK.
- * - handleWaitETX: Lida com o estado STATE_WAIT_ETX.
- *
- * A função processByte processa cada byte da mensagem de entrada e atualiza o estado da FSM de acordo.
- * A função testFSM testa a FSM com uma mensagem de exemplo.
+ * A função testFSM testa a FSM com uma mensagem de exemplo; os demais testes cobrem
+ * o codificador, o processamento em bloco, a entrega sem cópia, o modo com escape (byte-stuffing),
+ * a decodificação paralela, o limite de intervalo entre bytes, a versão 2 (LEN de 16 bits e CRC-16)
+ * e o despacho de quadros por tipo de mensagem.
+ * Compilado com -DPROTOCOL_STATS, testa também as estatísticas.
  *
  */
 #include <stdio.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
 
-typedef enum {
-    STATE_WAIT_STX,
-    STATE_READ_QTD,
-    STATE_READ_DATA,
-    STATE_READ_CHK,
-    STATE_WAIT_ETX,
-    STATE_COMPLETE,
-    STATE_ERROR
-} State;
+#include "protocol.h"
+#include "parallelDecoder.h"
+#include "crc16.h"
 
-typedef struct {
-    State currentState;
-    uint8_t qtd;
-    uint8_t data[256];
-    uint8_t chk;
-    uint8_t dataIndex;
-} FSM;
+/* macros de testes - baseado em minUnit: www.jera.com/techinfo/jtns/jtn002.html */
+#define verifica(mensagem, teste) do { if (!(teste)) return mensagem; } while (0)
+#define executa_teste(teste) do { char *mensagem = teste(); testes_executados++; \
+                                if (mensagem) return mensagem; } while (0)
 
-typedef bool (*StateHandler)(FSM *fsm, uint8_t byte);
+int testes_executados = 0;
+
+/* Alimenta a FSM byte a byte; retorna quantos quadros foram completados */
+static int decodeBytes(FSM *fsm, const uint8_t *buf, size_t len) {
+    int frames = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (processByte(fsm, buf[i])) {
+            frames++;
+        }
+    }
+    return frames;
+}
+
+static char * testFSM(void) {
+    FSM fsm;
+    resetFSM(&fsm);
+
+    uint8_t message[] = {0x02, 0x03, 'A', 'B', 'C', 0x05, 0x03};
+    bool result = false;
+
+    for (int i = 0; i < sizeof(message); i++) {
+        result = processByte(&fsm, message[i]);
+        if (result) {
+            break;
+        }
+    }
 
-bool handleWaitSTX(FSM *fsm, uint8_t byte);
-bool handleReadQTD(FSM *fsm, uint8_t byte);
-bool handleReadData(FSM *fsm, uint8_t byte);
-bool handleReadCHK(FSM *fsm, uint8_t byte);
-bool handleWaitETX(FSM *fsm, uint8_t byte);
+    verifica("erro: mensagem de exemplo não foi decodificada", result);
+    verifica("erro: dados incorretos", memcmp(fsm.data, "ABC", 3) == 0);
+    return 0;
+}
 
-StateHandler stateTable[] = {
-    handleWaitSTX,
-    handleReadQTD,
-    handleReadData,
-    handleReadCHK,
-    handleWaitETX
-};
+/* Quadros consecutivos não podem perder o STX do segundo quadro */
+static char * testBackToBack(void) {
+    FSM fsm;
+    uint8_t buf[2 * MAX_FRAME_SIZE];
+    size_t n;
 
-void resetFSM(FSM *fsm) {
-    fsm->currentState = STATE_WAIT_STX;
-    fsm->qtd = 0;
-    fsm->chk = 0;
-    fsm->dataIndex = 0;
+    resetFSM(&fsm);
+    n = encodeFrame((const uint8_t *)"AB", 2, buf, false);
+    n += encodeFrame((const uint8_t *)"", 0, buf + n, false);
+    verifica("erro: quadros consecutivos perdidos", decodeBytes(&fsm, buf, n) == 2);
+    verifica("erro: quadro vazio com QTD incorreto", fsm.qtd == 0);
+    verifica("erro: CHK do quadro vazio", checksumOk(&fsm));
+    return 0;
 }
 
-bool handleWaitSTX(FSM *fsm, uint8_t byte) {
-    if (byte == 0x02) { // STX
-        fsm->currentState = STATE_READ_QTD;
+/* Payload com todos os bytes especiais deve sobreviver ao escape */
+static char * testEscapedRoundTrip(void) {
+    const uint8_t payload[] = {STX, 'x', ETX, DLE, ETX ^ DLE_XOR, 0xff, STX};
+    uint8_t buf[MAX_FRAME_SIZE];
+    FSM fsm;
+    size_t n;
+
+    n = encodeFrame(payload, sizeof(payload), buf, true);
+    for (size_t i = 1; i + 1 < n; i++) {
+        verifica("erro: delimitador cru dentro do quadro", buf[i] != STX && buf[i] != ETX);
     }
-    return false;
+
+    resetFSM(&fsm);
+    setEscapedMode(&fsm, true);
+    verifica("erro: quadro com escape não decodificado", decodeBytes(&fsm, buf, n) == 1);
+    verifica("erro: QTD incorreto", fsm.qtd == sizeof(payload));
+    verifica("erro: dados incorretos", memcmp(fsm.data, payload, sizeof(payload)) == 0);
+    verifica("erro: CHK incorreto", checksumOk(&fsm));
+    return 0;
 }
 
-bool handleReadQTD(FSM *fsm, uint8_t byte) {
-    fsm->qtd = byte;
-    fsm->currentState = STATE_READ_DATA;
-    return false;
+/* Após um quadro truncado, o próximo STX ressincroniza a FSM */
+static char * testEscapedResync(void) {
+    const uint8_t payload[] = {STX, STX, ETX, 'a', 'b'};
+    uint8_t buf[2 * MAX_FRAME_SIZE];
+    FSM fsm;
+    size_t n, first;
+
+    first = encodeFrame(payload, sizeof(payload), buf, true);
+    n = encodeFrame(payload, sizeof(payload), buf + first / 2, true) + first / 2;
+
+    resetFSM(&fsm);
+    setEscapedMode(&fsm, true);
+    verifica("erro: ressincronização falhou", decodeBytes(&fsm, buf, n) == 1);
+    verifica("erro: dados incorretos", memcmp(fsm.data, payload, sizeof(payload)) == 0);
+    return 0;
 }
 
-bool handleReadData(FSM *fsm, uint8_t byte) {
-    fsm->data[fsm->dataIndex++] = byte;
-    if (fsm->dataIndex == fsm->qtd) {
-        fsm->currentState = STATE_READ_CHK;
+/* processBuffer deve produzir os mesmos quadros que processByte */
+static char * testProcessBuffer(void) {
+    uint8_t payload[200];
+    uint8_t buf[3 * MAX_FRAME_SIZE];
+    FSM fsm;
+
+    for (size_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = (uint8_t)(i * 7);
     }
-    return false;
+
+    for (int escaped = 0; escaped <= 1; escaped++) {
+        size_t n = 0, pos = 0;
+        int frames = 0;
+
+        n += encodeFrame(payload, sizeof(payload), buf + n, escaped);
+        n += encodeFrame(payload, 3, buf + n, escaped);
+        n += encodeFrame(payload + 50, 100, buf + n, escaped);
+
+        resetFSM(&fsm);
+        setEscapedMode(&fsm, escaped);
+        while (pos < n) {
+            bool complete;
+            pos += processBuffer(&fsm, buf + pos, n - pos, &complete);
+            if (complete) {
+                verifica("erro: CHK incorreto no processamento em bloco", checksumOk(&fsm));
+                frames++;
+            }
+        }
+        verifica("erro: quadros perdidos no processamento em bloco", frames == 3);
+        verifica("erro: dados incorretos no processamento em bloco",
+                 fsm.qtd == 100 && memcmp(fsm.data, payload + 50, 100) == 0);
+    }
+    return 0;
 }
 
-bool handleReadCHK(FSM *fsm, uint8_t byte) {
-    fsm->chk = byte;
-    fsm->currentState = STATE_WAIT_ETX;
-    return false;
+/* decodeFrames deve apontar para o buffer de entrada e copiar só o quadro partido */
+static char * testDecodeFrames(void) {
+    uint8_t payload[100];
+    uint8_t buf[4 * MAX_FRAME_SIZE];
+    size_t n = 0;
+
+    for (size_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = (uint8_t)(i + 1);
+    }
+    n += encodeFrame(payload, 40, buf + n, false);
+    n += encodeFrame(payload, 0, buf + n, false);
+    n += encodeFrame(payload, 100, buf + n, false);
+    buf[n - 1] = 'x'; // ETX corrompido
+    n += encodeFrame(payload + 10, 60, buf + n, false);
+    buf[n - 2] ^= 1;  // CHK corrompido
+
+    static const FrameStatus expected[] = {FRAME_OK, FRAME_OK, FRAME_BAD_ETX, FRAME_BAD_CHECKSUM};
+    static const uint8_t lengths[] = {40, 0, 100, 60};
+    static const uint8_t offsets[] = {0, 0, 0, 10};
+
+    // Divide o fluxo em dois buffers em todas as posições possíveis
+    for (size_t split = 0; split <= n; split++) {
+        size_t count = 0;
+        FSM fsm;
+
+        resetFSM(&fsm);
+        for (int part = 0; part < 2; part++) {
+            const uint8_t *base = part == 0 ? buf : buf + split;
+            size_t len = part == 0 ? split : n - split;
+            size_t pos = 0;
+
+            while (pos < len) {
+                Frame frames[8];
+                size_t used;
+                size_t got = decodeFrames(&fsm, base + pos, len - pos, frames, 8, &used);
+                verifica("erro: nenhum byte consumido", used > 0);
+                verifica("erro: quadros demais", count + got <= 4);
+                for (size_t f = 0; f < got; f++, count++) {
+                    verifica("erro: estado do quadro", frames[f].status == expected[count]);
+                    verifica("erro: tamanho do quadro", frames[f].length == lengths[count]);
+                    if (!frames[f].copied) {
+                        verifica("erro: payload fora do buffer",
+                                 frames[f].payload >= base + pos && frames[f].payload < base + pos + frames[f].end);
+                    } else if (frames[f].length > 0) {
+                        verifica("erro: cópia de quadro que não atravessa os buffers", pos == 0);
+                        verifica("erro: quadro copiado não é o último descritor", f == got - 1);
+                    }
+                    if (expected[count] != FRAME_BAD_ETX) {
+                        verifica("erro: dados do quadro",
+                                 memcmp(frames[f].payload, payload + offsets[count], lengths[count]) == 0);
+                    }
+                }
+                pos += used;
+            }
+        }
+        verifica("erro: quantidade de quadros", count == 4);
+    }
+    return 0;
 }
 
-bool handleWaitETX(FSM *fsm, uint8_t byte) {
-    if (byte == 0x03) { // ETX
-        fsm->currentState = STATE_COMPLETE;
-        return true;
-    } else {
-        fsm->currentState = STATE_ERROR;
+/* Fluxo com quadros, lixo entre quadros e bytes corrompidos */
+static uint8_t * buildNoisyStream(unsigned seed, int frames, size_t *len) {
+    uint8_t *stream = malloc((size_t)frames * (MAX_FRAME_SIZE + 8));
+    uint8_t payload[MAX_DATA];
+    size_t n = 0;
+
+    srand(seed);
+    for (int f = 0; f < frames; f++) {
+        uint8_t qtd = (uint8_t)(rand() % (MAX_DATA + 1));
+        for (int i = 0; i < qtd; i++) {
+            payload[i] = (uint8_t)rand();
+        }
+        size_t start = n;
+        n += encodeFrame(payload, qtd, stream + n, false);
+        if (rand() % 8 == 0) {
+            stream[start + rand() % (n - start)] = (uint8_t)rand();
+        }
+        for (int g = rand() % 4; g > 0; g--) {
+            stream[n++] = (uint8_t)(rand() % 2 ? STX : rand());
+        }
     }
-    return false;
+    *len = n;
+    return stream;
 }
 
-bool processByte(FSM *fsm, uint8_t byte) {
-    if (fsm->currentState < STATE_COMPLETE) {
-        return stateTable[fsm->currentState](fsm, byte);
+/* A decodificação paralela deve ser idêntica à sequencial */
+static char * testParallelDecoder(void) {
+    size_t len;
+    uint8_t *stream = buildNoisyStream(42, 2000, &len);
+    FrameList expected, result;
+
+    verifica("erro: memória da lista sequencial", decodeSequential(stream, len, &expected));
+    verifica("erro: nenhum quadro decodificado", expected.count > 1000);
+    for (int threads = 1; threads <= 16; threads++) {
+        verifica("erro: memória da lista paralela", decodeParallel(stream, len, threads, &result));
+        int same = result.count == expected.count;
+        for (size_t i = 0; same && i < result.count; i++) {
+            same = result.records[i].payload == expected.records[i].payload &&
+                   result.records[i].end == expected.records[i].end &&
+                   result.records[i].length == expected.records[i].length &&
+                   result.records[i].status == expected.records[i].status;
+        }
+        freeFrameList(&result);
+        verifica("erro: decodificação paralela divergiu da sequencial", same);
     }
-    resetFSM(fsm);
-    return false;
+    freeFrameList(&expected);
+    free(stream);
+    return 0;
 }
 
-void testFSM() {
+/* Um quadro truncado não pode consumir os bytes do quadro seguinte quando há limite de intervalo */
+static char * testGapTimeout(void) {
+    uint8_t payload[10] = "0123456789";
+    uint8_t buf[2 * MAX_FRAME_SIZE];
+    size_t first = encodeFrame(payload, sizeof(payload), buf, false) - 6; // Truncado
+    size_t n = first + encodeFrame(payload, sizeof(payload), buf + first, false);
+
+    for (int limit = 0; limit <= 1; limit++) {
+        FSM fsm;
+        int frames = 0, aborted = 0;
+        resetFSM(&fsm);
+        setGapTimeout(&fsm, limit ? 35 : 0); // t3.5 em unidades de 10 tempos de byte
+        for (size_t i = 0; i < n; i++) {
+            // 10 unidades por byte; linha em silêncio antes do segundo quadro
+            uint32_t t = (uint32_t)(10 * i + (i >= first ? 1000 : 0));
+            aborted += checkTimeout(&fsm, t - 5);
+            frames += processByteAt(&fsm, buf[i], t) && checksumOk(&fsm);
+        }
+        if (limit) {
+            verifica("erro: quadro truncado não abandonado", aborted == 1);
+            verifica("erro: quadro seguinte perdido", frames == 1);
+            verifica("erro: dados do quadro seguinte", memcmp(fsm.data, payload, 10) == 0);
+        } else {
+            verifica("erro: sem limite, o quadro seguinte é corrompido", frames == 0);
+        }
+    }
+
+    // Mesmo com o limite, a contagem de tempo deve sobreviver à volta do contador
     FSM fsm;
+    int frames = 0;
     resetFSM(&fsm);
+    setGapTimeout(&fsm, 35);
+    for (size_t i = first; i < n; i++) {
+        frames += processByteAt(&fsm, buf[i], (uint32_t)(0xfffffff0u + 10 * (i - first)));
+    }
+    verifica("erro: volta do contador de tempo", frames == 1);
+    return 0;
+}
 
-    uint8_t message[] = {0x02, 0x03, 'A', 'B', 'C', 0x05, 0x03};
-    bool result = false;
+/* Chama decodeFrames até consumir o bloco inteiro */
+static size_t decodeAll(FSM *fsm, const uint8_t *buf, size_t len, Frame *frames, size_t max) {
+    size_t count = 0, pos = 0;
+    while (pos < len && count < max) {
+        size_t used;
+        count += decodeFrames(fsm, buf + pos, len - pos, frames + count, max - count, &used);
+        pos += used;
+    }
+    return count;
+}
 
-    for (int i = 0; i < sizeof(message); i++) {
-        result = processByte(&fsm, message[i]);
-        if (result) {
-            printf("Sucesso!\n");
-            break;
+/* CRC-16/CCITT bit a bit, como referência para as tabelas */
+static uint16_t crc16Bitwise(const uint8_t *data, size_t len) {
+    uint16_t crc = CRC16_INIT;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)(data[i] << 8);
+        for (int b = 0; b < 8; b++) {
+            crc = crc & 0x8000 ? (uint16_t)(crc << 1) ^ 0x1021 : (uint16_t)(crc << 1);
         }
     }
+    return crc;
+}
 
-    if (!result) {
-        printf("Falha!\n");
+static char * testCrc16(void) {
+    uint8_t data[64];
+
+    verifica("erro: valor de verificação do CRC", crc16((const uint8_t *)"123456789", 9) == 0x29B1);
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 37 + 11);
+    }
+    for (size_t len = 0; len <= sizeof(data); len++) {
+        verifica("erro: CRC por tabelas difere do bit a bit", crc16(data, len) == crc16Bitwise(data, len));
+        verifica("erro: CRC incremental",
+                 crc16Update(crc16(data, len / 3), data + len / 3, len - len / 3) == crc16(data, len));
     }
+    return 0;
 }
 
-int main() {
-    testFSM();
+/* Quadros v1 e v2 misturados, byte a byte e sem cópia, com e sem escape */
+static char * testProtocolV2(void) {
+    static uint8_t payload[4096], received[4096];
+    static uint8_t buf[FRAME_V2_SIZE(4096) + 2 * MAX_FRAME_SIZE];
+    static const uint16_t lengths[] = {10, 4096, 0, 20};
+    static const uint8_t versions[] = {1, 2, 2, 1};
+
+    for (size_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = (uint8_t)(i * 13 + (i >> 8));
+    }
+    for (int escaped = 0; escaped <= 1; escaped++) {
+        size_t n = 0;
+        n += encodeFrame(payload, 10, buf + n, escaped);
+        n += encodeFrameV2(payload, 4096, buf + n, escaped);
+        n += encodeFrameV2(payload, 0, buf + n, escaped);
+        n += encodeFrame(payload, 20, buf + n, escaped);
+
+        FSM fsm;
+        int frames = 0;
+        resetFSM(&fsm);
+        setEscapedMode(&fsm, escaped);
+        enableProtocolV2(&fsm, received, sizeof(received));
+        for (size_t i = 0; i < n; i++) {
+            if (processByte(&fsm, buf[i])) {
+                verifica("erro: versão do quadro", fsm.version == versions[frames]);
+                verifica("erro: tamanho do quadro v2", fsm.qtd == lengths[frames]);
+                verifica("erro: CRC/CHK do quadro", checksumOk(&fsm));
+                verifica("erro: dados do quadro", memcmp(frameData(&fsm), payload, fsm.qtd) == 0);
+                frames++;
+            }
+        }
+        verifica("erro: quadros v1/v2 perdidos", frames == 4);
+
+        // Sem cópia, em dois buffers
+        static const size_t splits[] = {0, 1, 3, 5, 20, 100, 2000, 4100};
+        for (size_t k = 0; k < sizeof(splits) / sizeof(splits[0]); k++) {
+            size_t split = splits[k], count;
+            Frame out[8];
+            resetFSM(&fsm);
+            setEscapedMode(&fsm, escaped);
+            enableProtocolV2(&fsm, received, sizeof(received));
+            count = decodeAll(&fsm, buf, split, out, 8);
+            count += decodeAll(&fsm, buf + split, n - split, out + count, 8 - count);
+            verifica("erro: quantidade de quadros v1/v2 sem cópia", count == 4);
+            for (size_t f = 0; f < count; f++) {
+                verifica("erro: estado do quadro sem cópia", out[f].status == FRAME_OK);
+                verifica("erro: versão do quadro sem cópia", out[f].version == versions[f]);
+                verifica("erro: tamanho do quadro sem cópia", out[f].length == lengths[f]);
+            }
+        }
+    }
+
+    // Quadro v2 maior que o buffer: erro no caminho com cópia, sem erro no caminho sem cópia
+    size_t n = encodeFrameV2(payload, 4096, buf, false);
+    size_t used;
+    Frame out[1];
+    FSM fsm;
+    resetFSM(&fsm);
+    enableProtocolV2(&fsm, received, 100);
+    bool complete;
+    processBuffer(&fsm, buf, n, &complete);
+    verifica("erro: quadro v2 maior que o buffer",
+             !complete && fsm.currentState == STATE_ERROR && frameStatus(&fsm) == FRAME_BAD_LENGTH);
+
+    // Com decodeFrames, o quadro grande que precisa de cópia (dividido ou com escape) também gera
+    // um descritor FRAME_BAD_LENGTH, e o quadro seguinte é decodificado
+    memset(payload, 'v', 4096);
+    for (int escaped = 0; escaped <= 1; escaped++) {
+        static const size_t splits[] = {0, 5, 100, 2000};
+        size_t total = encodeFrameV2(payload, 4096, buf, escaped);
+        total += encodeFrame((const uint8_t *)"ok", 2, buf + total, escaped);
+        for (size_t k = escaped ? 0 : 1; k < sizeof(splits) / sizeof(splits[0]); k++) {
+            Frame frames[4];
+            size_t count;
+            resetFSM(&fsm);
+            setEscapedMode(&fsm, escaped);
+            enableProtocolV2(&fsm, received, 100);
+            count = decodeAll(&fsm, buf, splits[k], frames, 4);
+            count += decodeAll(&fsm, buf + splits[k], total - splits[k], frames + count, 4 - count);
+            verifica("erro: quadro v2 grande sem descritor", count == 2 && frames[0].version == 2 &&
+                     frames[0].status == FRAME_BAD_LENGTH && frames[0].copied);
+            verifica("erro: quadro seguinte ao v2 grande", frames[1].status == FRAME_OK &&
+                     frames[1].length == 2 && memcmp(frames[1].payload, "ok", 2) == 0);
+        }
+    }
+
+    n = encodeFrameV2(payload, 4096, buf, false);
+    resetFSM(&fsm);
+    enableProtocolV2(&fsm, NULL, 0);
+    verifica("erro: quadro v2 inteiro sem buffer",
+             decodeFrames(&fsm, buf, n, out, 1, &used) == 1 && out[0].status == FRAME_OK &&
+             !out[0].copied && out[0].payload == buf + 4);
+
+    // Sem enableProtocolV2, V2_MARKER continua sendo um QTD da versão 1
+    memset(payload, 'v', MAX_DATA);
+    n = encodeFrame(payload, V2_MARKER, buf, false);
+    resetFSM(&fsm);
+    verifica("erro: QTD 255 na versão 1", decodeBytes(&fsm, buf, n) == 1 && fsm.qtd == V2_MARKER);
     return 0;
-}
\ No newline at end of file
+}
+
+#ifdef PROTOCOL_STATS
+/* Os contadores devem classificar cada quadro, pelo caminho byte a byte e pelo sem cópia */
+static char * testStats(void) {
+    uint8_t payload[20] = "estatisticas";
+    uint8_t buf[4 * MAX_FRAME_SIZE];
+    size_t n = 0, used;
+    Frame frames[8];
+    ProtocolStats stats;
+    FSM fsm;
+
+    buf[n++] = 'x';
+    buf[n++] = 'y';
+    n += encodeFrame(payload, sizeof(payload), buf + n, false);
+    n += encodeFrame(payload, 5, buf + n, false);
+    buf[n - 2] ^= 1;  // CHK corrompido
+    n += encodeFrame(payload, 7, buf + n, false);
+    buf[n - 1] = 'z'; // ETX corrompido
+
+    for (int path = 0; path < 2; path++) {
+        resetFSM(&fsm);
+        if (path == 0) {
+            decodeBytes(&fsm, buf, n);
+        } else {
+            decodeFrames(&fsm, buf, n, frames, 8, &used);
+        }
+        getStats(&fsm, &stats);
+        verifica("erro: quadros ok", stats.frames[FRAME_OK] == 1);
+        verifica("erro: CHK incorreto", stats.frames[FRAME_BAD_CHECKSUM] == 1);
+        verifica("erro: ETX incorreto", stats.frames[FRAME_BAD_ETX] == 1);
+        verifica("erro: bytes descartados", stats.discarded == 2);
+        verifica("erro: ciclos por estado", stats.stateCycles[STATE_READ_DATA] > 0);
+    }
+
+    // Quadro abandonado por STX cru no modo com escape
+    n = encodeFrame(payload, sizeof(payload), buf, true);
+    n += encodeFrame(payload, sizeof(payload), buf + n / 2, true) - n / 2;
+    resetFSM(&fsm);
+    setEscapedMode(&fsm, true);
+    decodeBytes(&fsm, buf, n);
+    getStats(&fsm, &stats);
+    verifica("erro: ressincronização", stats.resyncs == 1 && stats.frames[FRAME_OK] == 1);
+    return 0;
+}
+#endif
+
+/* Contadores do teste de despacho */
+typedef struct {
+    int calls;
+    uint16_t length;
+    uint8_t first;
+    const uint8_t *payload;
+} HandlerLog;
+
+static void logFrame(void *context, const uint8_t *payload, uint16_t length) {
+    HandlerLog *log = context;
+    log->calls++;
+    log->length = length;
+    log->first = length ? payload[0] : 0;
+    log->payload = payload;
+}
+
+/* Cada quadro correto vai para o tratador do seu tipo, em todos os caminhos do decodificador */
+static char * testDispatch(void) {
+    uint8_t buf[5 * MAX_FRAME_SIZE];
+    HandlerLog logA, logB, other;
+    Dispatcher dispatcher;
+    Frame frames[8];
+    size_t n = 0, used;
+    FSM fsm;
+
+    n += encodeFrame((const uint8_t *)"Aum", 3, buf + n, false);
+    n += encodeFrame((const uint8_t *)"Bdois", 5, buf + n, false);
+    n += encodeFrame((const uint8_t *)"Atres", 5, buf + n, false);
+    buf[n - 2] ^= 1; // CHK corrompido: não é despachado
+    n += encodeFrame((const uint8_t *)"", 0, buf + n, false);
+    n += encodeFrame((const uint8_t *)"Zx", 2, buf + n, false);
+
+    initDispatcher(&dispatcher, logFrame, &other);
+    registerHandler(&dispatcher, 'A', logFrame, &logA);
+    registerHandler(&dispatcher, 'B', logFrame, &logB);
+
+    for (int path = 0; path < 3; path++) {
+        memset(&logA, 0, sizeof(logA));
+        memset(&logB, 0, sizeof(logB));
+        memset(&other, 0, sizeof(other));
+        resetFSM(&fsm);
+        setDispatcher(&fsm, &dispatcher);
+        if (path == 0) {
+            decodeBytes(&fsm, buf, n);
+        } else if (path == 1) {
+            for (size_t pos = 0; pos < n;) {
+                bool complete;
+                pos += processBuffer(&fsm, buf + pos, n - pos, &complete);
+            }
+        } else {
+            verifica("erro: descritores não entregues com despacho",
+                     decodeFrames(&fsm, buf, n, frames, 8, &used) == 5 && used == n);
+            verifica("erro: despacho copiou os dados", logB.payload == frames[1].payload);
+        }
+        verifica("erro: tratador do tipo A", logA.calls == 1 && logA.length == 3);
+        verifica("erro: tratador do tipo B", logB.calls == 1 && logB.first == 'B' && logB.length == 5);
+        verifica("erro: tratador padrão", other.calls == 2 && other.first == 'Z');
+    }
+
+    // Sem tabela associada, nenhum tratador é chamado
+    memset(&logA, 0, sizeof(logA));
+    resetFSM(&fsm);
+    decodeBytes(&fsm, buf, n);
+    verifica("erro: despacho sem tabela", logA.calls == 0);
+    return 0;
+}
+
+/* Função que executa todos os testes */
+static char * executa_testes(void) {
+    executa_teste(testFSM);
+    executa_teste(testBackToBack);
+    executa_teste(testEscapedRoundTrip);
+    executa_teste(testEscapedResync);
+    executa_teste(testProcessBuffer);
+    executa_teste(testDecodeFrames);
+    executa_teste(testParallelDecoder);
+    executa_teste(testGapTimeout);
+    executa_teste(testCrc16);
+    executa_teste(testProtocolV2);
+    executa_teste(testDispatch);
+#ifdef PROTOCOL_STATS
+    executa_teste(testStats);
+#endif
+    return 0;
+}
+
+int main() {
+    char *resultado = executa_testes();
+    if (resultado != 0) {
+        printf("%s\n", resultado);
+    } else {
+        printf("Sucesso!\n");
+    }
+    printf("Testes executados: %d\n", testes_executados);
+
+    return resultado != 0;
+}
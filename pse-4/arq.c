@@ -0,0 +1,284 @@
+/**
+ * @file arq.c
+ * @brief Implementação do ARQ descrito em arq.h.
+ *
+ * Confirmações: em stop-and-wait e Go-Back-N, seq é o próximo quadro que o receptor espera
+ * (cumulativa); em repetição seletiva, seq é o quadro recebido.
+ */
+#include <stddef.h>
+#include <string.h>
+
+#include "arq.h"
+#include "lossyLink.h"
+#include "ptClock.h"
+#include "ptProfile.h"
+
+#define SLOT(seq) ((seq) & (ARQ_MAX_WINDOW - 1))
+
+static bool expired(uint32_t deadline, uint32_t now) {
+    return (int32_t)(now - deadline) >= 0;
+}
+
+void arqSenderInit(ArqSender *s, ArqMode mode, unsigned window, LossyLink *out, LossyLink *in,
+                   uint32_t total, ArqFill fill, void *context, uint32_t rtoInitial, uint32_t rtoMin) {
+    PT_INIT(&s->pt);
+    s->mode = mode;
+    s->window = mode == ARQ_STOP_AND_WAIT ? 1 : window < 1 ? 1 : window > ARQ_MAX_WINDOW ? ARQ_MAX_WINDOW : window;
+    s->out = out;
+    s->in = in;
+    s->fill = fill;
+    s->context = context;
+    s->total = total;
+    s->base = s->next = 0;
+    s->srtt8 = s->rttvar4 = 0;
+    s->rto = rtoInitial;
+    s->rtoMin = rtoMin;
+    s->rttValid = false;
+    s->transmissions = s->retransmissions = s->timeouts = s->rttSamples = 0;
+}
+
+void arqReceiverInit(ArqReceiver *r, ArqMode mode, unsigned window, LossyLink *in, LossyLink *out,
+                     uint32_t total, ArqDeliver deliver, void *context) {
+    PT_INIT(&r->pt);
+    r->mode = mode;
+    r->window = mode == ARQ_STOP_AND_WAIT ? 1 : window < 1 ? 1 : window > ARQ_MAX_WINDOW ? ARQ_MAX_WINDOW : window;
+    r->in = in;
+    r->out = out;
+    r->deliver = deliver;
+    r->context = context;
+    r->total = total;
+    r->expected = 0;
+    memset(r->have, 0, sizeof(r->have));
+    r->duplicates = r->discarded = 0;
+}
+
+/* RTO = SRTT + 4 RTTVAR, sem o recuo dos vencimentos */
+static void resetRto(ArqSender *s) {
+    s->rto = s->srtt8 / 8 + (s->rttvar4 > 1 ? s->rttvar4 : 1);
+    if (s->rto < s->rtoMin) {
+        s->rto = s->rtoMin;
+    }
+    if (s->rto > ARQ_RTO_MAX) {
+        s->rto = ARQ_RTO_MAX;
+    }
+}
+
+/* RFC 6298, com srtt e rttvar em ponto fixo (x8 e x4) */
+static void sampleRtt(ArqSender *s, uint32_t rtt) {
+    if (!s->rttValid) {
+        s->srtt8 = rtt * 8;
+        s->rttvar4 = rtt * 2;
+        s->rttValid = true;
+    } else {
+        int32_t delta = (int32_t)rtt - (int32_t)(s->srtt8 / 8);
+        s->rttvar4 += (uint32_t)(delta < 0 ? -delta : delta) - s->rttvar4 / 4;
+        s->srtt8 += (uint32_t)delta;  // srtt += delta / 8
+    }
+    s->rttSamples++;
+    resetRto(s);
+}
+
+static void transmit(ArqSender *s, uint32_t seq, bool resend, uint32_t now) {
+    unsigned slot = SLOT(seq);
+    ArqFrame frame;
+
+    frame.seq = seq;
+    frame.length = s->length[slot];
+    frame.ack = false;
+    memcpy(frame.data, s->data[slot], frame.length);
+    s->transmissions++;
+    if (resend) {
+        s->retransmissions++;
+        s->resent[slot] = true;
+    }
+    s->sentAt[slot] = now;
+    s->deadline[slot] = now + s->rto;
+    linkSend(s->out, &frame);
+}
+
+static void handleAck(ArqSender *s, const ArqFrame *ack, uint32_t now) {
+    if (s->mode == ARQ_SELECTIVE_REPEAT) {
+        uint32_t seq = ack->seq;
+        if (seq - s->base >= s->next - s->base || s->acked[SLOT(seq)]) {
+            return; // Fora da janela ou repetida
+        }
+        s->acked[SLOT(seq)] = true;
+        if (!s->resent[SLOT(seq)]) {
+            sampleRtt(s, now - s->sentAt[SLOT(seq)]);
+        }
+        uint32_t base = s->base;
+        while (s->base != s->next && s->acked[SLOT(s->base)]) {
+            s->base++;
+        }
+        if (s->base != base && s->rttValid) {
+            resetRto(s);
+        }
+        return;
+    }
+    // Cumulativa: ack->seq é o próximo esperado
+    uint32_t advance = ack->seq - s->base;
+    if (advance == 0 || advance > s->next - s->base) {
+        return; // Repetida ou inválida
+    }
+    uint32_t last = ack->seq - 1;
+    if (!s->resent[SLOT(last)]) {
+        sampleRtt(s, now - s->sentAt[SLOT(last)]);
+    } else if (s->rttValid) {
+        resetRto(s);
+    }
+    s->base = ack->seq;
+    if (s->base != s->next) {
+        // Reinicia o temporizador único, agora do quadro mais antigo pendente
+        s->deadline[SLOT(s->base)] = now + s->rto;
+    }
+}
+
+static void checkTimers(ArqSender *s, uint32_t now) {
+    bool fired = false;
+
+    if (s->base == s->next) {
+        return;
+    }
+    if (s->mode == ARQ_SELECTIVE_REPEAT) {
+        for (uint32_t seq = s->base; seq != s->next; seq++) {
+            if (!s->acked[SLOT(seq)] && expired(s->deadline[SLOT(seq)], now)) {
+                if (!fired) {
+                    // Um recuo por vencimento, mesmo que vários quadros vençam juntos
+                    s->timeouts++;
+                    s->rto = s->rto * 2 > ARQ_RTO_MAX ? ARQ_RTO_MAX : s->rto * 2;
+                    fired = true;
+                }
+                transmit(s, seq, true, now);
+            }
+        }
+        return;
+    }
+    if (expired(s->deadline[SLOT(s->base)], now)) {
+        s->timeouts++;
+        s->rto = s->rto * 2 > ARQ_RTO_MAX ? ARQ_RTO_MAX : s->rto * 2;
+        for (uint32_t seq = s->base; seq != s->next; seq++) {
+            transmit(s, seq, true, now);
+        }
+    }
+}
+
+/* Condição de espera do transmissor; anota os prazos pendentes para ptClockIdle */
+static bool senderHasWork(ArqSender *s) {
+    uint32_t now = ptClockMs();
+
+    if (linkReady(s->in) || (s->next < s->total && s->next - s->base < s->window)) {
+        return true;
+    }
+    if (s->base == s->next) {
+        return false;
+    }
+    if (s->mode != ARQ_SELECTIVE_REPEAT) {
+        if (expired(s->deadline[SLOT(s->base)], now)) {
+            return true;
+        }
+        ptClockNoteDeadline(s->deadline[SLOT(s->base)]);
+        return false;
+    }
+    for (uint32_t seq = s->base; seq != s->next; seq++) {
+        if (!s->acked[SLOT(seq)]) {
+            if (expired(s->deadline[SLOT(seq)], now)) {
+                return true;
+            }
+            ptClockNoteDeadline(s->deadline[SLOT(seq)]);
+        }
+    }
+    return false;
+}
+
+PT_THREAD(arqSenderRun(ArqSender *s))
+{
+    ArqFrame ack;
+    uint32_t now;
+
+    PT_BEGIN(&s->pt);
+    while (s->base < s->total) {
+        PT_WAIT_UNTIL(&s->pt, senderHasWork(s));
+        now = ptClockMs();
+        while (linkReceive(s->in, &ack)) {
+            if (ack.ack) {
+                handleAck(s, &ack, now);
+            }
+        }
+        checkTimers(s, now);
+        while (s->next < s->total && s->next - s->base < s->window) {
+            unsigned slot = SLOT(s->next);
+            s->length[slot] = s->fill(s->context, s->next, s->data[slot]);
+            s->acked[slot] = false;
+            s->resent[slot] = false;
+            transmit(s, s->next, false, now);
+            s->next++;
+        }
+    }
+    PT_END(&s->pt);
+}
+
+static void sendAck(ArqReceiver *r, uint32_t seq) {
+    ArqFrame ack;
+
+    ack.seq = seq;
+    ack.length = 0;
+    ack.ack = true;
+    linkSend(r->out, &ack);
+}
+
+static void receive(ArqReceiver *r, const ArqFrame *frame) {
+    uint32_t seq = frame->seq;
+
+    if (r->mode != ARQ_SELECTIVE_REPEAT) {
+        if (seq == r->expected && r->expected < r->total) {
+            r->deliver(r->context, seq, frame->data, frame->length);
+            r->expected++;
+        } else if (seq < r->expected) {
+            r->duplicates++;
+        } else {
+            r->discarded++; // Fora de ordem: Go-Back-N descarta e espera a retransmissão
+        }
+        sendAck(r, r->expected);
+        return;
+    }
+    if (seq < r->expected) {
+        r->duplicates++;
+        sendAck(r, seq); // A confirmação anterior se perdeu
+        return;
+    }
+    if (seq - r->expected >= r->window || seq >= r->total) {
+        r->discarded++;
+        return;
+    }
+    unsigned slot = SLOT(seq);
+    if (r->have[slot]) {
+        r->duplicates++;
+    } else {
+        r->have[slot] = true;
+        r->length[slot] = frame->length;
+        memcpy(r->data[slot], frame->data, frame->length);
+    }
+    sendAck(r, seq);
+    while (r->have[SLOT(r->expected)]) {
+        slot = SLOT(r->expected);
+        r->have[slot] = false;
+        r->deliver(r->context, r->expected, r->data[slot], r->length[slot]);
+        r->expected++;
+    }
+}
+
+PT_THREAD(arqReceiverRun(ArqReceiver *r))
+{
+    ArqFrame frame;
+
+    PT_BEGIN(&r->pt);
+    for (;;) {
+        PT_WAIT_UNTIL(&r->pt, linkReceive(r->in, &frame));
+        do {
+            if (!frame.ack) {
+                receive(r, &frame);
+            }
+        } while (linkReceive(r->in, &frame));
+    }
+    PT_END(&r->pt);
+}
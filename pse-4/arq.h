@@ -0,0 +1,124 @@
+/**
+ * @file arq.h
+ * @brief Retransmissão automática (ARQ) entre protothreads: stop-and-wait, Go-Back-N e
+ * repetição seletiva, com RTO adaptativo.
+ *
+ * Um ArqSender envia total quadros numerados por um enlace (lossyLink.h) e recebe as
+ * confirmações pelo enlace do sentido contrário; um ArqReceiver entrega os dados em ordem, uma
+ * única vez, e confirma. Os dois são protothreads (arqSenderRun/arqReceiverRun) para o laço de
+ * varredura e esperam com PT_WAIT_UNTIL por um quadro chegado, uma vaga na janela ou o
+ * vencimento de um temporizador, anotando os prazos para ptClockIdle (ptClock.h).
+ *
+ * Modos:
+ * - ARQ_STOP_AND_WAIT: um quadro por vez (janela 1); vazão limitada a um quadro por RTT.
+ * - ARQ_GO_BACK_N: até window quadros sem confirmação; a confirmação é cumulativa (próximo
+ *   quadro esperado) e o receptor descarta o que chega fora de ordem. Um único temporizador,
+ *   do quadro mais antigo; no vencimento, todos os quadros pendentes são reenviados.
+ * - ARQ_SELECTIVE_REPEAT: o receptor guarda os quadros fora de ordem dentro da janela e
+ *   confirma cada um; cada quadro pendente tem o seu prazo e só ele é reenviado.
+ *
+ * Com janela W, a vazão cresce com W até o produto banda-atraso do enlace, em vez de ficar
+ * presa a um quadro por RTT.
+ *
+ * O RTO segue o RFC 6298: SRTT e RTTVAR estimados das amostras de RTT (só de quadros não
+ * retransmitidos, pela regra de Karn), RTO = SRTT + 4 RTTVAR, limitado a [rtoMin, ARQ_RTO_MAX],
+ * e dobrado a cada vencimento. O recuo é desfeito na próxima amostra válida ou quando uma
+ * confirmação avança a janela: em Go-Back-N com janela grande, todos os quadros pendentes são
+ * retransmitidos e a regra de Karn deixaria o RTO no máximo por muito tempo.
+ */
+#ifndef ARQ_H
+#define ARQ_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "pt-1.4/pt.h"
+
+#define ARQ_PAYLOAD    256    // Bytes de dados por quadro
+#define ARQ_MAX_WINDOW 128    // Maior janela (potência de 2)
+#define ARQ_RTO_MAX    60000  // ms
+
+typedef struct LossyLink LossyLink;
+
+typedef enum {
+    ARQ_STOP_AND_WAIT,
+    ARQ_GO_BACK_N,
+    ARQ_SELECTIVE_REPEAT,
+} ArqMode;
+
+typedef struct {
+    uint32_t seq;       // Dados: número do quadro; confirmação: ver arq.c
+    uint16_t length;    // Bytes em data (0 em confirmações)
+    bool ack;
+    uint8_t data[ARQ_PAYLOAD];
+} ArqFrame;
+
+/** Preenche os dados do quadro seq; retorna o tamanho (até ARQ_PAYLOAD). */
+typedef uint16_t (*ArqFill)(void *context, uint32_t seq, uint8_t *data);
+
+/** Recebe os dados do quadro seq, em ordem e uma única vez. */
+typedef void (*ArqDeliver)(void *context, uint32_t seq, const uint8_t *data, uint16_t length);
+
+typedef struct {
+    struct pt pt;
+    ArqMode mode;
+    unsigned window;
+    LossyLink *out, *in;      // Dados / confirmações
+    ArqFill fill;
+    void *context;
+    uint32_t total;           // Quadros a enviar
+    uint32_t base, next;      // Mais antigo sem confirmação / próximo a enviar pela primeira vez
+    // Por posição da janela (seq % ARQ_MAX_WINDOW)
+    uint32_t sentAt[ARQ_MAX_WINDOW];
+    uint32_t deadline[ARQ_MAX_WINDOW];
+    bool acked[ARQ_MAX_WINDOW];
+    bool resent[ARQ_MAX_WINDOW];
+    uint16_t length[ARQ_MAX_WINDOW];
+    uint8_t data[ARQ_MAX_WINDOW][ARQ_PAYLOAD];
+    // RTO (ms; srtt e rttvar multiplicados por 8 e 4, como no TCP)
+    uint32_t srtt8, rttvar4, rto, rtoMin;
+    bool rttValid;
+    // Estatísticas
+    uint64_t transmissions, retransmissions, timeouts, rttSamples;
+} ArqSender;
+
+typedef struct {
+    struct pt pt;
+    ArqMode mode;
+    unsigned window;
+    LossyLink *in, *out;      // Dados / confirmações
+    ArqDeliver deliver;
+    void *context;
+    uint32_t total;           // Quadros esperados
+    uint32_t expected;        // Próximo quadro a entregar
+    bool have[ARQ_MAX_WINDOW];
+    uint16_t length[ARQ_MAX_WINDOW];
+    uint8_t data[ARQ_MAX_WINDOW][ARQ_PAYLOAD];
+    uint64_t duplicates, discarded;
+} ArqReceiver;
+
+/**
+ * Prepara o transmissor. window é limitada a ARQ_MAX_WINDOW (1 em stop-and-wait); rtoInitial é o
+ * RTO antes da primeira amostra e rtoMin o menor RTO calculado.
+ */
+void arqSenderInit(ArqSender *s, ArqMode mode, unsigned window, LossyLink *out, LossyLink *in,
+                   uint32_t total, ArqFill fill, void *context, uint32_t rtoInitial, uint32_t rtoMin);
+
+void arqReceiverInit(ArqReceiver *r, ArqMode mode, unsigned window, LossyLink *in, LossyLink *out,
+                     uint32_t total, ArqDeliver deliver, void *context);
+
+/** Protothread do transmissor: termina quando todos os quadros foram confirmados. */
+PT_THREAD(arqSenderRun(ArqSender *s));
+
+/**
+ * Protothread do receptor. Não termina: a confirmação dos últimos quadros pode se perder, e o
+ * transmissor só termina quando o receptor confirma as retransmissões; o laço de varredura
+ * termina com o transmissor. arqReceiverDone indica se todos os quadros já foram entregues.
+ */
+PT_THREAD(arqReceiverRun(ArqReceiver *r));
+
+static inline bool arqReceiverDone(const ArqReceiver *r) {
+    return r->expected >= r->total;
+}
+
+#endif // ARQ_H
@@ -0,0 +1,98 @@
+/**
+ * @file bulkBench.c
+ * @brief Vazão da transferência em massa: três laços sobre o vetor inteiro vs buffer duplo com
+ * cópia e validação fundidas (bulkPipe.c).
+ *
+ * O caminho original do transmissionProtothread, com DATA_SIZE inteiros:
+ *   - transmissor: data_buffer[i] = i;
+ *   - receptor: received_data[i] = data_buffer[i], depois um laço comparando received_data[i] com i.
+ * O caminho em blocos: bulkProducer preenche um bloco de BULK_BLOCK inteiros enquanto
+ * bulkConsumer copia e valida o anterior, alternados pelo laço de varredura.
+ *
+ * Para cada DATA_SIZE, repete a transferência até somar cerca de REPETE_ELEMENTOS inteiros e
+ * relata o melhor de RODADAS (ns por inteiro e MB/s de dados entregues).
+ *
+ *   bulkBench [maior DATA_SIZE]   (padrão 16M inteiros)
+ */
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "bulkPipe.h"
+
+#define RODADAS          5
+#define REPETE_ELEMENTOS (64u << 20)
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Laços separados, como no transmissionProtothread original */
+static bool elementWise(int *data_buffer, int *received_data, size_t size) {
+    bool data_valid = true;
+
+    for (size_t index = 0; index < size; index++) {
+        data_buffer[index] = (int)index;
+    }
+    for (size_t index = 0; index < size; index++) {
+        received_data[index] = data_buffer[index];
+    }
+    for (size_t index = 0; index < size; index++) {
+        if (received_data[index] != (int)index) {
+            data_valid = false;
+        }
+    }
+    return data_valid;
+}
+
+static bool pipelined(BulkPipe *pipe, int *received_data, size_t size) {
+    bulkPipeInit(pipe, received_data, size, 0);
+    while (PT_SCHEDULE(bulkConsumer(pipe))) {
+        (void)PT_SCHEDULE(bulkProducer(pipe));
+    }
+    return pipe->valid;
+}
+
+int main(int argc, char *argv[]) {
+    size_t largest = argc > 1 ? (size_t)atol(argv[1]) : (size_t)16 << 20;
+    static BulkPipe pipe;
+    int *data_buffer = malloc(largest * sizeof(int));
+    int *received_data = malloc(largest * sizeof(int));
+
+    if (data_buffer == NULL || received_data == NULL) {
+        fprintf(stderr, "erro: sem memória para %zu inteiros\n", largest);
+        return 1;
+    }
+    printf("%12s %12s %12s %12s %12s %8s\n", "DATA_SIZE", "laços ns/int", "MB/s",
+           "blocos ns/int", "MB/s", "ganho");
+    for (size_t size = 1024; size <= largest; size *= 4) {
+        unsigned repeat = size >= REPETE_ELEMENTOS ? 1 : (unsigned)(REPETE_ELEMENTOS / size);
+        double best[2] = {1e9, 1e9};
+
+        for (int round = 0; round < RODADAS; round++) {
+            for (int variant = 0; variant < 2; variant++) {
+                double start = now();
+                for (unsigned r = 0; r < repeat; r++) {
+                    bool valid = variant == 0 ? elementWise(data_buffer, received_data, size)
+                                              : pipelined(&pipe, received_data, size);
+                    if (!valid) {
+                        fprintf(stderr, "erro: dados incorretos\n");
+                        return 1;
+                    }
+                }
+                double ns = (now() - start) * 1e9 / ((double)repeat * size);
+                if (ns < best[variant]) {
+                    best[variant] = ns;
+                }
+            }
+        }
+        printf("%12zu %12.3f %12.0f %12.3f %12.0f %7.2fx\n", size, best[0], sizeof(int) * 1e3 / best[0],
+               best[1], sizeof(int) * 1e3 / best[1], best[0] / best[1]);
+    }
+    free(data_buffer);
+    free(received_data);
+    return 0;
+}
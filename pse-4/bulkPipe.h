@@ -0,0 +1,66 @@
+/**
+ * @file bulkPipe.h
+ * @brief Transferência em massa com buffer duplo entre protothreads, com cópia e validação
+ * fundidas.
+ *
+ * O caminho original do transmissionProtothread percorre os dados três vezes: o transmissor
+ * preenche o buffer, o receptor copia elemento a elemento e depois valida em um segundo laço.
+ * Com DATA_SIZE grande, cada passagem lê e escreve o vetor inteiro na memória principal.
+ *
+ * Aqui a transferência é dividida em blocos de BULK_BLOCK inteiros e dois buffers: o produtor
+ * (bulkProducer) preenche o próximo bloco enquanto o consumidor (bulkConsumer) copia e valida o
+ * atual em uma única passagem (bulkCopyValidate). Na mesma thread as duas protothreads se
+ * alternam pelo laço de varredura; o ganho vem de o bloco ainda estar na cache quando o
+ * consumidor o lê, e de a cópia e a validação dividirem as mesmas leituras.
+ *
+ *   bulkPipeInit(&pipe, dst, total, 0);
+ *   while (PT_SCHEDULE(bulkConsumer(&pipe))) {
+ *       (void)PT_SCHEDULE(bulkProducer(&pipe));
+ *   }
+ *   if (!pipe.valid) { ... }
+ *
+ * Os dados são a sequência first, first + 1, ... (como no exemplo). bulkFill e bulkCopyValidate
+ * aceitam buffers sem alinhamento (os dados de um quadro do ARQ, por exemplo).
+ */
+#ifndef BULK_PIPE_H
+#define BULK_PIPE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "pt-1.4/pt.h"
+
+#define BULK_BLOCK 2048 // Inteiros por bloco (8 KiB: os dois blocos e o destino cabem na L1/L2)
+
+/** Escreve first, first + 1, ... nos n inteiros de dst. */
+void bulkFill(void *dst, size_t n, int first);
+
+/**
+ * Copia n inteiros de src para dst e, na mesma passagem, verifica se src[i] == first + i.
+ * Copia tudo mesmo com erro; retorna se todos estavam corretos.
+ */
+bool bulkCopyValidate(int *dst, const void *src, size_t n, int first);
+
+typedef struct {
+    struct pt producer, consumer;
+    int blocks[2][BULK_BLOCK];
+    size_t length[2];      // Inteiros em cada bloco cheio
+    unsigned filled;       // Blocos produzidos (o bloco i usa o buffer i % 2)
+    unsigned drained;      // Blocos consumidos
+    size_t produced;       // Inteiros produzidos
+    size_t consumed;       // Inteiros copiados para dst
+    int *dst;
+    size_t total;
+    int first;
+    bool valid;            // Todos os blocos consumidos estavam corretos
+} BulkPipe;
+
+void bulkPipeInit(BulkPipe *p, int *dst, size_t total, int first);
+
+/** Preenche os blocos livres; termina depois de produzir total inteiros. */
+PT_THREAD(bulkProducer(BulkPipe *p));
+
+/** Copia e valida os blocos cheios em dst; termina depois de consumir total inteiros. */
+PT_THREAD(bulkConsumer(BulkPipe *p));
+
+#endif // BULK_PIPE_H
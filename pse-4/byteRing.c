@@ -0,0 +1,61 @@
+/**
+ * @file byteRing.c
+ * @brief Implementação do buffer circular de bytes descrito em byteRing.h.
+ */
+#include <string.h>
+
+#include "byteRing.h"
+
+void ringInit(ByteRing *ring, uint8_t *storage, size_t capacity) {
+    ring->storage = storage;
+    ring->mask = capacity - 1;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+}
+
+bool ringPut(ByteRing *ring, uint8_t byte) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    if (head - tail > ring->mask) {
+        return false;
+    }
+    ring->storage[head & ring->mask] = byte;
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return true;
+}
+
+size_t ringWrite(ByteRing *ring, const uint8_t *buf, size_t len) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    size_t space = ring->mask + 1 - (head - tail);
+    size_t offset = head & ring->mask;
+
+    if (len > space) {
+        len = space;
+    }
+    // Até duas cópias: do fim do armazenamento e, dando a volta, do início
+    size_t first = ring->mask + 1 - offset;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(ring->storage + offset, buf, first);
+    memcpy(ring->storage, buf + first, len - first);
+    atomic_store_explicit(&ring->head, head + len, memory_order_release);
+    return len;
+}
+
+size_t ringReadable(ByteRing *ring, const uint8_t **data) {
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t count = atomic_load_explicit(&ring->head, memory_order_acquire) - tail;
+    size_t offset = tail & ring->mask;
+    size_t contiguous = ring->mask + 1 - offset;
+
+    *data = ring->storage + offset;
+    return count < contiguous ? count : contiguous;
+}
+
+void ringConsume(ByteRing *ring, size_t n) {
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    atomic_store_explicit(&ring->tail, tail + n, memory_order_release);
+}
@@ -0,0 +1,53 @@
+/**
+ * @file byteRing.h
+ * @brief Buffer circular de bytes com um produtor e um consumidor.
+ *
+ * O produtor (tipicamente a interrupção de recepção da UART) só escreve head e o consumidor só
+ * escreve tail, então não há trava: basta que cada lado publique o seu índice depois de
+ * escrever/ler os bytes (ordem garantida pelos atomics de C11). Os índices crescem livremente e
+ * são reduzidos com a máscara da capacidade, que deve ser potência de 2.
+ *
+ * O consumidor lê sem cópia: ringReadable devolve o maior trecho contíguo disponível, que pode
+ * ser entregue diretamente a processBuffer/decodeFrames, e ringConsume libera os bytes usados.
+ */
+#ifndef BYTE_RING_H
+#define BYTE_RING_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    uint8_t *storage;
+    size_t mask;           // Capacidade - 1
+    atomic_size_t head;    // Próxima posição de escrita (produtor)
+    atomic_size_t tail;    // Próxima posição de leitura (consumidor)
+} ByteRing;
+
+/** Inicializa o buffer sobre storage, de capacity bytes (potência de 2). */
+void ringInit(ByteRing *ring, uint8_t *storage, size_t capacity);
+
+/** Produtor: insere um byte. Retorna false se o buffer está cheio (byte perdido). */
+bool ringPut(ByteRing *ring, uint8_t byte);
+
+/** Produtor: insere até len bytes e retorna quantos couberam. */
+size_t ringWrite(ByteRing *ring, const uint8_t *buf, size_t len);
+
+/** Consumidor: aponta *data para o maior trecho contíguo disponível e retorna o seu tamanho. */
+size_t ringReadable(ByteRing *ring, const uint8_t **data);
+
+/** Consumidor: libera n bytes já lidos. */
+void ringConsume(ByteRing *ring, size_t n);
+
+/** Bytes disponíveis para o consumidor. */
+static inline size_t ringCount(ByteRing *ring) {
+    return atomic_load_explicit(&ring->head, memory_order_acquire) -
+           atomic_load_explicit(&ring->tail, memory_order_relaxed);
+}
+
+static inline bool ringIsEmpty(ByteRing *ring) {
+    return ringCount(ring) == 0;
+}
+
+#endif // BYTE_RING_H
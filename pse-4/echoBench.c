@@ -0,0 +1,223 @@
+/**
+ * @file echoBench.c
+ * @brief Servidor de eco com milhares de conexões: reator de epoll contra varredura.
+ *
+ * CONEXOES pares de sockets (socketpair AF_UNIX) ligam um cliente a uma protothread servidora
+ * que devolve o que lê. Só ATIVAS conexões trocam mensagens (MENSAGEM bytes, RODADAS vezes cada,
+ * uma mensagem em trânsito por conexão); as demais ficam ociosas, como em um gateway, até os
+ * clientes ativos terminarem e as fecharem. Clientes e servidores são tarefas do mesmo
+ * escalonador, em dois modos:
+ *
+ * - reator: ao receber EAGAIN, a tarefa espera com PT_WAIT_READABLE/PT_WAIT_WRITABLE e só é
+ *   executada quando o epoll acusa o descritor pronto;
+ * - varredura: ao receber EAGAIN, a tarefa cede a vez (PT_YIELD) e tenta de novo na volta
+ *   seguinte, como um PT_WAIT_UNTIL sobre um read não bloqueante.
+ *
+ * Relata mensagens ecoadas por segundo, execuções de tarefas, leituras/escritas com EAGAIN e
+ * chamadas a epoll_wait.
+ *
+ *   echoBench [conexões [ativas]]   (padrão 2000 e 200)
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "reactor.h"
+#include "scheduler.h"
+
+#define MENSAGEM 64
+#define RODADAS  200
+
+typedef struct {
+    Task task;
+    int fd;
+    uint8_t buf[MENSAGEM];
+    size_t length, offset;  // Bytes no buf / já reenviados
+    unsigned round;
+} Peer;
+
+static bool polling;          // Modo varredura
+static uint64_t wasted;       // read/write com EAGAIN
+static uint64_t echoed;
+static unsigned activeLeft;   // Clientes ativos ainda trocando mensagens
+static int *idleClients;      // Extremidades dos clientes ociosos, fechadas no fim
+static int idleCount;
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static PT_THREAD(server(Task *task))
+{
+    Peer *self = (Peer *)task;
+    ssize_t n;
+
+    PT_BEGIN(&task->pt);
+    for (;;) {
+        n = read(self->fd, self->buf, sizeof(self->buf));
+        if (n < 0 && errno == EAGAIN) {
+            wasted++;
+            if (polling) {
+                PT_YIELD(&task->pt);
+            } else {
+                PT_WAIT_READABLE(task, self->fd);
+            }
+            continue;
+        }
+        if (n <= 0) {
+            break; // Cliente fechou a conexão
+        }
+        self->length = (size_t)n;
+        for (self->offset = 0; self->offset < self->length;) {
+            n = write(self->fd, self->buf + self->offset, self->length - self->offset);
+            if (n < 0 && errno == EAGAIN) {
+                wasted++;
+                if (polling) {
+                    PT_YIELD(&task->pt);
+                } else {
+                    PT_WAIT_WRITABLE(task, self->fd);
+                }
+                continue;
+            }
+            if (n < 0) {
+                break;
+            }
+            self->offset += (size_t)n;
+        }
+    }
+    PT_END(&task->pt);
+}
+
+static PT_THREAD(client(Task *task))
+{
+    Peer *self = (Peer *)task;
+    ssize_t n;
+
+    PT_BEGIN(&task->pt);
+    for (self->round = 0; self->round < RODADAS; self->round++) {
+        memset(self->buf, (int)self->round, sizeof(self->buf));
+        for (self->offset = 0; self->offset < MENSAGEM;) {
+            n = write(self->fd, self->buf + self->offset, MENSAGEM - self->offset);
+            if (n < 0 && errno == EAGAIN) {
+                wasted++;
+                if (polling) {
+                    PT_YIELD(&task->pt);
+                } else {
+                    PT_WAIT_WRITABLE(task, self->fd);
+                }
+                continue;
+            }
+            if (n < 0) {
+                perror("write");
+                exit(1);
+            }
+            self->offset += (size_t)n;
+        }
+        for (self->length = 0; self->length < MENSAGEM;) {
+            n = read(self->fd, self->buf, MENSAGEM - self->length);
+            if (n < 0 && errno == EAGAIN) {
+                wasted++;
+                if (polling) {
+                    PT_YIELD(&task->pt);
+                } else {
+                    PT_WAIT_READABLE(task, self->fd);
+                }
+                continue;
+            }
+            if (n <= 0) {
+                perror("read");
+                exit(1);
+            }
+            self->length += (size_t)n;
+        }
+        echoed++;
+    }
+    // Último cliente ativo: fecha as conexões ociosas para os servidores terminarem
+    if (--activeLeft == 0) {
+        for (int i = 0; i < idleCount; i++) {
+            shutdown(idleClients[i], SHUT_RDWR);
+        }
+    }
+    shutdown(self->fd, SHUT_RDWR);
+    PT_END(&task->pt);
+}
+
+static void run(int connections, int active, bool poll) {
+    Peer *servers = calloc((size_t)connections, sizeof(Peer));
+    Peer *clients = calloc((size_t)active, sizeof(Peer));
+    int (*fds)[2] = malloc((size_t)connections * sizeof(*fds));
+    Scheduler scheduler;
+    Reactor reactor;
+
+    polling = poll;
+    wasted = echoed = 0;
+    activeLeft = (unsigned)active;
+    idleCount = 0;
+    idleClients = malloc((size_t)connections * sizeof(int));
+
+    schedulerInit(&scheduler);
+    if (!polling && !reactorInit(&reactor, &scheduler)) {
+        perror("epoll");
+        exit(1);
+    }
+    for (int i = 0; i < connections; i++) {
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds[i]) < 0) {
+            perror("socketpair");
+            exit(1);
+        }
+        fcntl(fds[i][0], F_SETFL, O_NONBLOCK);
+        fcntl(fds[i][1], F_SETFL, O_NONBLOCK);
+        servers[i].fd = fds[i][0];
+        taskSpawn(&scheduler, &servers[i].task, server);
+        if (i < active) {
+            clients[i].fd = fds[i][1];
+            taskSpawn(&scheduler, &clients[i].task, client);
+        } else {
+            idleClients[idleCount++] = fds[i][1];
+        }
+    }
+
+    double start = now();
+    schedulerRun(&scheduler);
+    double elapsed = now() - start;
+
+    printf("%-9s conexões=%-6d ativas=%-5d %7.3f s %9.0f msgs/s  execuções %9llu  EAGAIN %10llu  "
+           "epoll_wait %7llu\n", polling ? "varredura" : "reator", connections, active, elapsed,
+           echoed / elapsed, (unsigned long long)scheduler.runs, (unsigned long long)wasted,
+           polling ? 0ull : (unsigned long long)reactor.waits);
+
+    if (!polling) {
+        reactorDestroy(&reactor);
+    }
+    schedulerDestroy(&scheduler);
+    for (int i = 0; i < connections; i++) {
+        close(fds[i][0]);
+        close(fds[i][1]);
+    }
+    free(idleClients);
+    free(fds);
+    free(clients);
+    free(servers);
+}
+
+int main(int argc, char *argv[]) {
+    int connections = argc > 1 ? atoi(argv[1]) : 2000;
+    int active = argc > 2 ? atoi(argv[2]) : connections / 10;
+
+    if (active < 1 || active > connections) {
+        fprintf(stderr, "uso: echoBench [conexões [ativas]]\n");
+        return 1;
+    }
+    run(connections, active, false);
+    run(connections, active, true);
+    return 0;
+}
@@ -0,0 +1,195 @@
+/**
+ * @file execBench.c
+ * @brief Escalabilidade do executor com roubo de trabalho (executor.c) de 1 a N workers.
+ *
+ * Dois cenários, repetidos para cada número de workers:
+ *
+ * - gateway: CONEXOES protothreads, uma por conexão, cada uma decodificando com a sua FSM
+ *   (processBuffer do pse-3) um fluxo de quadros de 64 bytes de dados e cedendo a vez a cada
+ *   quadro. A carga é desbalanceada (a conexão i decodifica 1 a 8 vezes QUADROS quadros) e as
+ *   tarefas são distribuídas em rodízio, então o roubo de trabalho é o que mantém os workers
+ *   ocupados no fim.
+ * - pingpong: PARES pares de protothreads que se acordam com execWake a cada rodada, medindo o
+ *   custo do acordar sem travas entre workers.
+ *
+ * Relata tempo, vazão, speedup em relação a 1 worker, execuções e roubos.
+ *
+ *   execBench [workers máximo]   (padrão: 2x o número de núcleos)
+ */
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include <unistd.h>
+
+#include "executor.h"
+#include "protocol.h"
+
+#define CONEXOES  10000
+#define QUADROS   40     // Quadros por conexão (vezes 1 a 8)
+#define DADOS     64
+#define PARES     2000
+#define RODADAS   500
+
+static uint8_t stream[64 * (DADOS + 4)];
+static size_t streamLength;
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+typedef struct {
+    ExecTask task;
+    FSM fsm;
+    size_t offset;
+    unsigned frames, target;
+} Connection;
+
+static PT_THREAD(connection(ExecTask *task))
+{
+    Connection *c = (Connection *)task;
+
+    PT_BEGIN(&task->pt);
+    while (c->frames < c->target) {
+        bool complete = false;
+        c->offset += processBuffer(&c->fsm, stream + c->offset, streamLength - c->offset, &complete);
+        if (c->offset == streamLength) {
+            c->offset = 0;
+        }
+        if (complete) {
+            c->frames++;
+            PT_YIELD(&task->pt);
+        }
+    }
+    PT_END(&task->pt);
+}
+
+typedef struct PingPong PingPong;
+
+typedef struct {
+    ExecTask task;
+    PingPong *pair;
+    unsigned round;
+} Player;
+
+struct PingPong {
+    Player ping, pong;
+    atomic_uint turn;
+};
+
+static PT_THREAD(ping(ExecTask *task))
+{
+    Player *self = (Player *)task;
+
+    PT_BEGIN(&task->pt);
+    for (self->round = 0; self->round < RODADAS; self->round++) {
+        PT_WAIT_UNTIL(&task->pt, atomic_load_explicit(&self->pair->turn, memory_order_acquire) == 0);
+        atomic_store_explicit(&self->pair->turn, 1, memory_order_release);
+        execWake(&self->pair->pong.task);
+    }
+    PT_END(&task->pt);
+}
+
+static PT_THREAD(pong(ExecTask *task))
+{
+    Player *self = (Player *)task;
+
+    PT_BEGIN(&task->pt);
+    for (self->round = 0; self->round < RODADAS; self->round++) {
+        PT_WAIT_UNTIL(&task->pt, atomic_load_explicit(&self->pair->turn, memory_order_acquire) == 1);
+        atomic_store_explicit(&self->pair->turn, 0, memory_order_release);
+        execWake(&self->pair->ping.task);
+    }
+    PT_END(&task->pt);
+}
+
+static double benchGateway(unsigned workers, double base) {
+    Connection *conns = malloc(CONEXOES * sizeof(Connection));
+    Executor ex;
+    uint64_t frames = 0;
+
+    if (!executorInit(&ex, workers)) {
+        fprintf(stderr, "erro: sem memória para %u workers\n", workers);
+        exit(1);
+    }
+    for (int i = 0; i < CONEXOES; i++) {
+        resetFSM(&conns[i].fsm);
+        conns[i].offset = 0;
+        conns[i].frames = 0;
+        conns[i].target = QUADROS * (1 + (unsigned)(i % 8));
+        frames += conns[i].target;
+        execSpawn(&ex, &conns[i].task, connection);
+    }
+    double start = now();
+    executorRun(&ex);
+    double elapsed = now() - start;
+
+    printf("gateway   workers=%-3u %7.3f s %8.2f Mquadros/s  speedup %5.2fx  execuções %9llu  roubos %7llu\n",
+           workers, elapsed, frames / elapsed / 1e6, base > 0 ? base / elapsed : 1.0,
+           (unsigned long long)ex.runs, (unsigned long long)ex.steals);
+    executorDestroy(&ex);
+    free(conns);
+    return elapsed;
+}
+
+static double benchPingPong(unsigned workers, double base) {
+    PingPong *pairs = malloc(PARES * sizeof(PingPong));
+    Executor ex;
+
+    if (!executorInit(&ex, workers)) {
+        fprintf(stderr, "erro: sem memória para %u workers\n", workers);
+        exit(1);
+    }
+    for (int i = 0; i < PARES; i++) {
+        pairs[i].ping.pair = pairs[i].pong.pair = &pairs[i];
+        atomic_init(&pairs[i].turn, 0);
+        execSpawn(&ex, &pairs[i].ping.task, ping);
+        execSpawn(&ex, &pairs[i].pong.task, pong);
+    }
+    double start = now();
+    executorRun(&ex);
+    double elapsed = now() - start;
+
+    printf("pingpong  workers=%-3u %7.3f s %8.2f Mrodadas/s  speedup %5.2fx  execuções %9llu  roubos %7llu\n",
+           workers, elapsed, (double)PARES * RODADAS / elapsed / 1e6, base > 0 ? base / elapsed : 1.0,
+           (unsigned long long)ex.runs, (unsigned long long)ex.steals);
+    executorDestroy(&ex);
+    free(pairs);
+    return elapsed;
+}
+
+int main(int argc, char *argv[]) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned max = argc > 1 ? (unsigned)atoi(argv[1]) : (unsigned)(2 * cores);
+    uint8_t payload[DADOS];
+    double base;
+
+    for (int i = 0; i < DADOS; i++) {
+        payload[i] = (uint8_t)(i * 37);
+    }
+    while (streamLength + DADOS + 4 <= sizeof(stream)) {
+        streamLength += encodeFrame(payload, DADOS, stream + streamLength, false);
+    }
+
+    printf("núcleos: %ld\n", cores);
+    base = 0;
+    for (unsigned workers = 1; workers <= max; workers *= 2) {
+        double elapsed = benchGateway(workers, base);
+        if (workers == 1) {
+            base = elapsed;
+        }
+    }
+    base = 0;
+    for (unsigned workers = 1; workers <= max; workers *= 2) {
+        double elapsed = benchPingPong(workers, base);
+        if (workers == 1) {
+            base = elapsed;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,368 @@
+/**
+ * @file executor.c
+ * @brief Implementação do executor com roubo de trabalho descrito em executor.h.
+ */
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "executor.h"
+
+#define DEQUE_CAPACITY 4096 // Tarefas por deque (potência de 2); o excesso vai para a caixa de entrada
+
+// Estados de ExecTask.state
+enum {
+    EXEC_IDLE,      // Parada, esperando execWake
+    EXEC_QUEUED,    // Em uma fila ou caixa de entrada
+    EXEC_RUNNING,   // Executando em um worker
+    EXEC_NOTIFIED,  // Acordada durante a execução: volta para a fila ao terminar
+    EXEC_DONE
+};
+
+/*
+ * Deque de Chase-Lev (versão com atomics de C11 de Lê et al., "Correct and Efficient
+ * Work-Stealing for Weak Memory Models"). O dono usa push/pop em bottom; os ladrões, steal em
+ * top. Os índices são com sinal porque pop decrementa bottom antes de comparar com top.
+ */
+typedef struct {
+    atomic_llong top;
+    atomic_llong bottom;
+    _Atomic(ExecTask *) buffer[DEQUE_CAPACITY];
+} Deque;
+
+struct Worker {
+    _Alignas(64) Deque deque;
+    _Atomic(ExecTask *) inbox;  // Pilha de tarefas acordadas por outras threads
+    Executor *executor;
+    unsigned index;
+    uint32_t random;            // Escolha da vítima de roubo
+    pthread_t thread;
+    bool started;               // thread criada por executorRun
+    uint64_t runs, steals;
+};
+
+static _Thread_local Worker *currentWorker;
+
+static bool dequePush(Deque *d, ExecTask *task) {
+    long long b = atomic_load_explicit(&d->bottom, memory_order_relaxed);
+    long long t = atomic_load_explicit(&d->top, memory_order_acquire);
+    if (b - t >= DEQUE_CAPACITY) {
+        return false;
+    }
+    atomic_store_explicit(&d->buffer[b & (DEQUE_CAPACITY - 1)], task, memory_order_relaxed);
+    atomic_store_explicit(&d->bottom, b + 1, memory_order_release);
+    return true;
+}
+
+static ExecTask * dequePop(Deque *d) {
+    long long b = atomic_load_explicit(&d->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&d->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long long t = atomic_load_explicit(&d->top, memory_order_relaxed);
+    ExecTask *task = NULL;
+
+    if (t <= b) {
+        task = atomic_load_explicit(&d->buffer[b & (DEQUE_CAPACITY - 1)], memory_order_relaxed);
+        if (t == b) {
+            // Último elemento: disputa com os ladrões por top
+            if (!atomic_compare_exchange_strong_explicit(&d->top, &t, t + 1, memory_order_seq_cst,
+                                                         memory_order_relaxed)) {
+                task = NULL;
+            }
+            atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+        }
+    } else {
+        atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+    }
+    return task;
+}
+
+static ExecTask * dequeSteal(Deque *d) {
+    long long t = atomic_load_explicit(&d->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long long b = atomic_load_explicit(&d->bottom, memory_order_acquire);
+
+    if (t < b) {
+        ExecTask *task = atomic_load_explicit(&d->buffer[t & (DEQUE_CAPACITY - 1)], memory_order_relaxed);
+        if (atomic_compare_exchange_strong_explicit(&d->top, &t, t + 1, memory_order_seq_cst,
+                                                    memory_order_relaxed)) {
+            return task;
+        }
+    }
+    return NULL;
+}
+
+static bool dequeEmpty(Deque *d) {
+    return atomic_load(&d->bottom) <= atomic_load(&d->top);
+}
+
+/* Caixa de entrada: pilha de Treiber só com inserções; quem a esvazia retira tudo de uma vez
+ * (sem ABA) */
+static void inboxPush(Worker *w, ExecTask *task) {
+    ExecTask *head = atomic_load_explicit(&w->inbox, memory_order_relaxed);
+    do {
+        task->inboxNext = head;
+    } while (!atomic_compare_exchange_weak_explicit(&w->inbox, &head, task, memory_order_release,
+                                                    memory_order_relaxed));
+}
+
+/* Avisa um worker dormindo que há trabalho novo (ver park) */
+static void notify(Executor *ex) {
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&ex->sleepers, memory_order_relaxed) > 0) {
+        atomic_fetch_add(&ex->epoch, 1);
+        pthread_mutex_lock(&ex->lock);
+        pthread_cond_signal(&ex->wake);
+        pthread_mutex_unlock(&ex->lock);
+    }
+}
+
+static void notifyAll(Executor *ex) {
+    atomic_fetch_add(&ex->epoch, 1);
+    pthread_mutex_lock(&ex->lock);
+    pthread_cond_broadcast(&ex->wake);
+    pthread_mutex_unlock(&ex->lock);
+}
+
+/* Coloca na fila uma tarefa já marcada EXEC_QUEUED */
+static void submit(Executor *ex, ExecTask *task) {
+    Worker *w = currentWorker;
+
+    if (w == NULL || w->executor != ex || !dequePush(&w->deque, task)) {
+        inboxPush(w != NULL && w->executor == ex ? w : &ex->workers[task->home], task);
+    }
+    notify(ex);
+}
+
+bool executorInit(Executor *ex, unsigned workers) {
+    if (workers == 0) {
+        workers = 1;
+    }
+    ex->workers = aligned_alloc(64, sizeof(Worker) * workers);
+    if (ex->workers == NULL) {
+        return false;
+    }
+    ex->count = workers;
+    for (unsigned i = 0; i < workers; i++) {
+        Worker *w = &ex->workers[i];
+        atomic_init(&w->deque.top, 0);
+        atomic_init(&w->deque.bottom, 0);
+        atomic_init(&w->inbox, NULL);
+        w->executor = ex;
+        w->index = i;
+        w->random = 2654435761u * (i + 1);
+        w->runs = w->steals = 0;
+    }
+    atomic_init(&ex->nextSpawn, 0);
+    atomic_init(&ex->live, 0);
+    atomic_init(&ex->stopped, false);
+    atomic_init(&ex->sleepers, 0);
+    atomic_init(&ex->epoch, 0);
+    pthread_mutex_init(&ex->lock, NULL);
+    pthread_cond_init(&ex->wake, NULL);
+    ex->runs = ex->steals = 0;
+    return true;
+}
+
+void executorDestroy(Executor *ex) {
+    pthread_mutex_destroy(&ex->lock);
+    pthread_cond_destroy(&ex->wake);
+    free(ex->workers);
+}
+
+void execSpawn(Executor *ex, ExecTask *task, ExecFunction function) {
+    PT_INIT(&task->pt);
+    task->function = function;
+    task->executor = ex;
+    task->inboxNext = NULL;
+    task->home = atomic_fetch_add_explicit(&ex->nextSpawn, 1, memory_order_relaxed) % ex->count;
+    atomic_store_explicit(&task->state, EXEC_QUEUED, memory_order_relaxed);
+    atomic_fetch_add(&ex->live, 1);
+    // Fora de um worker, vai para a caixa de entrada do próximo worker do rodízio
+    submit(ex, task);
+}
+
+void execWake(ExecTask *task) {
+    unsigned state = atomic_load_explicit(&task->state, memory_order_acquire);
+
+    for (;;) {
+        unsigned next;
+        if (state == EXEC_IDLE) {
+            next = EXEC_QUEUED;
+        } else if (state == EXEC_RUNNING) {
+            next = EXEC_NOTIFIED;
+        } else {
+            return; // Já na fila, já marcada ou terminada
+        }
+        if (atomic_compare_exchange_weak_explicit(&task->state, &state, next, memory_order_acq_rel,
+                                                  memory_order_acquire)) {
+            if (next == EXEC_QUEUED) {
+                submit(task->executor, task);
+            }
+            return;
+        }
+    }
+}
+
+/* Passa para o deque de w as tarefas da caixa de entrada de from (w ou uma vítima), na ordem
+ * em que chegaram. A caixa é retirada inteira com uma troca, o que vale para vários
+ * consumidores. */
+static void drainInbox(Worker *w, Worker *from) {
+    ExecTask *list = atomic_exchange_explicit(&from->inbox, NULL, memory_order_acquire);
+    ExecTask *fifo = NULL;
+
+    while (list != NULL) {
+        ExecTask *next = list->inboxNext;
+        list->inboxNext = fifo;
+        fifo = list;
+        list = next;
+    }
+    while (fifo != NULL) {
+        ExecTask *next = fifo->inboxNext;
+        if (!dequePush(&w->deque, fifo)) {
+            inboxPush(w, fifo); // Deque cheio: fica para a próxima vez
+        }
+        fifo = next;
+    }
+}
+
+/* Rouba uma tarefa de outro worker, começando por uma vítima aleatória. Sem tarefas nos deques,
+ * leva a caixa de entrada de uma vítima: o aviso de notify pode ter acordado este worker e não
+ * o dono da caixa. */
+static ExecTask * steal(Worker *w) {
+    Executor *ex = w->executor;
+
+    w->random ^= w->random << 13;
+    w->random ^= w->random >> 17;
+    w->random ^= w->random << 5;
+    for (unsigned i = 0, start = w->random % ex->count; i < ex->count; i++) {
+        Worker *victim = &ex->workers[(start + i) % ex->count];
+        if (victim == w) {
+            continue;
+        }
+        ExecTask *task = dequeSteal(&victim->deque);
+        if (task != NULL) {
+            w->steals++;
+            return task;
+        }
+    }
+    for (unsigned i = 0; i < ex->count; i++) {
+        Worker *victim = &ex->workers[i];
+        if (victim != w && atomic_load_explicit(&victim->inbox, memory_order_relaxed) != NULL) {
+            drainInbox(w, victim);
+            ExecTask *task = dequePop(&w->deque);
+            if (task != NULL) {
+                w->steals++;
+                return task;
+            }
+        }
+    }
+    return NULL;
+}
+
+static bool finished(Executor *ex) {
+    return atomic_load(&ex->live) == 0 || atomic_load(&ex->stopped);
+}
+
+static bool anyWork(Executor *ex) {
+    for (unsigned i = 0; i < ex->count; i++) {
+        if (!dequeEmpty(&ex->workers[i].deque) || atomic_load(&ex->workers[i].inbox) != NULL) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Dorme até haver trabalho. sleepers é incrementado antes de reexaminar as filas e notify lê
+ * sleepers depois de publicar a tarefa (ambos com ordem seq_cst): ou o worker encontra a tarefa,
+ * ou notify o vê e incrementa epoch com a trava, que o worker confere antes de dormir.
+ */
+static void park(Worker *w) {
+    Executor *ex = w->executor;
+
+    atomic_fetch_add(&ex->sleepers, 1);
+    unsigned epoch = atomic_load(&ex->epoch);
+    if (!anyWork(ex) && !finished(ex)) {
+        pthread_mutex_lock(&ex->lock);
+        if (atomic_load(&ex->epoch) == epoch) {
+            pthread_cond_wait(&ex->wake, &ex->lock);
+        }
+        pthread_mutex_unlock(&ex->lock);
+    }
+    atomic_fetch_sub(&ex->sleepers, 1);
+}
+
+static void runTask(Worker *w, ExecTask *task) {
+    Executor *ex = w->executor;
+
+    task->home = w->index;
+    atomic_store_explicit(&task->state, EXEC_RUNNING, memory_order_release);
+    char status = task->function(task);
+    w->runs++;
+
+    if (status >= PT_EXITED) {
+        atomic_store_explicit(&task->state, EXEC_DONE, memory_order_release);
+        if (atomic_fetch_sub(&ex->live, 1) == 1) {
+            notifyAll(ex);
+        }
+        return;
+    }
+    unsigned state = EXEC_RUNNING;
+    if (status == PT_YIELDED ||
+        !atomic_compare_exchange_strong_explicit(&task->state, &state, EXEC_IDLE,
+                                                 memory_order_acq_rel, memory_order_acquire)) {
+        // Cedeu a vez ou foi acordada durante a execução
+        atomic_store_explicit(&task->state, EXEC_QUEUED, memory_order_release);
+        submit(ex, task);
+    }
+}
+
+static void * workerLoop(void *arg) {
+    Worker *w = arg;
+    Executor *ex = w->executor;
+
+    currentWorker = w;
+    while (!finished(ex)) {
+        ExecTask *task = dequePop(&w->deque);
+        if (task == NULL && atomic_load_explicit(&w->inbox, memory_order_relaxed) != NULL) {
+            drainInbox(w, w);
+            task = dequePop(&w->deque);
+        }
+        if (task == NULL) {
+            task = steal(w);
+        }
+        if (task == NULL) {
+            park(w);
+            continue;
+        }
+        runTask(w, task);
+    }
+    currentWorker = NULL;
+    return NULL;
+}
+
+void executorRun(Executor *ex) {
+    atomic_store(&ex->stopped, false);
+    for (unsigned i = 1; i < ex->count; i++) {
+        // Sem a thread, o deque e a caixa de entrada do worker continuam sendo roubados
+        ex->workers[i].started =
+            pthread_create(&ex->workers[i].thread, NULL, workerLoop, &ex->workers[i]) == 0;
+    }
+    workerLoop(&ex->workers[0]);
+    for (unsigned i = 1; i < ex->count; i++) {
+        if (ex->workers[i].started) {
+            pthread_join(ex->workers[i].thread, NULL);
+        }
+    }
+
+    ex->runs = ex->steals = 0;
+    for (unsigned i = 0; i < ex->count; i++) {
+        ex->runs += ex->workers[i].runs;
+        ex->steals += ex->workers[i].steals;
+    }
+}
+
+void executorStop(Executor *ex) {
+    atomic_store(&ex->stopped, true);
+    notifyAll(ex);
+}
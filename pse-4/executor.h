@@ -0,0 +1,94 @@
+/**
+ * @file executor.h
+ * @brief Executor de protothreads em vários núcleos, com roubo de trabalho.
+ *
+ * Cada worker (uma thread do sistema) tem a sua fila de execução: um deque de Chase-Lev, em que
+ * o dono insere e retira pelo fim sem travas e os outros workers roubam pelo início quando
+ * ficam sem trabalho. As tarefas criadas com execSpawn são distribuídas entre os workers em
+ * rodízio; a partir daí uma tarefa roda no worker que a retirar da fila, e a continuação local
+ * da protothread (que não depende da pilha) permite retomá-la em qualquer um deles.
+ *
+ * O contrato é o de PT_SCHEDULE: cada execução da tarefa retorna o estado da protothread.
+ *   - PT_YIELDED: a tarefa volta para a fila do worker.
+ *   - PT_WAITING: a tarefa fica parada até alguém chamar execWake. Quem torna verdadeira a
+ *     condição de um PT_WAIT_UNTIL deve acordar a tarefa depois de alterá-la.
+ *   - PT_EXITED/PT_ENDED: a tarefa terminou.
+ *
+ * execWake pode ser chamada de qualquer thread e não usa travas: o estado da tarefa é uma
+ * variável atômica (parada, na fila, executando, acordada durante a execução, terminada). Um
+ * acordar durante a execução não se perde: ao terminar a execução, o worker vê o estado
+ * "acordada" e recoloca a tarefa na fila. De um worker, a tarefa acordada vai para a fila do
+ * próprio worker; de outra thread, para a caixa de entrada (pilha sem travas) do último worker
+ * que a executou (um worker ocioso pode levar a caixa de outro). Workers sem trabalho dormem em
+ * uma variável de condição e são acordados quando surge trabalho novo.
+ *
+ *   executorInit(&ex, 4);
+ *   for (...) execSpawn(&ex, &conn[i].task, connection);
+ *   executorRun(&ex);          // retorna quando todas as tarefas terminam
+ *   executorDestroy(&ex);
+ */
+#ifndef EXECUTOR_H
+#define EXECUTOR_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "pt-1.4/pt.h"
+
+typedef struct ExecTask ExecTask;
+typedef struct Executor Executor;
+typedef struct Worker Worker;
+
+/** Corpo de uma tarefa: uma protothread que recebe a própria tarefa. */
+typedef char (*ExecFunction)(ExecTask *task);
+
+struct ExecTask {
+    struct pt pt;
+    ExecFunction function;
+    Executor *executor;
+    ExecTask *inboxNext;  // Caixa de entrada de um worker
+    atomic_uint state;    // EXEC_* (executor.c)
+    unsigned home;        // Último worker que executou a tarefa
+};
+
+struct Executor {
+    Worker *workers;
+    unsigned count;           // Número de workers
+    atomic_uint nextSpawn;    // Rodízio de execSpawn
+    atomic_uint live;         // Tarefas não terminadas
+    atomic_bool stopped;
+    atomic_uint sleepers;     // Workers dormindo (ou prestes a dormir)
+    atomic_uint epoch;        // Incrementado a cada aviso de trabalho novo aos que dormem
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    uint64_t runs;            // Execuções de tarefas (somadas ao fim de executorRun)
+    uint64_t steals;          // Tarefas roubadas de outro worker
+};
+
+/**
+ * Inicializa o executor com workers filas (use o número de núcleos). Retorna false sem memória
+ * para os workers.
+ */
+bool executorInit(Executor *ex, unsigned workers);
+
+void executorDestroy(Executor *ex);
+
+/**
+ * Executa as tarefas em workers threads (a thread chamadora é o worker 0) até todas
+ * terminarem ou executorStop ser chamado. Se o sistema recusar uma thread, as tarefas do worker
+ * dela são roubadas pelos demais (com nenhuma thread criada, tudo roda na chamadora).
+ */
+void executorRun(Executor *ex);
+
+/** Faz executorRun retornar depois das execuções em andamento (qualquer thread). */
+void executorStop(Executor *ex);
+
+/** Inicializa a protothread da tarefa e a coloca na fila de um worker. */
+void execSpawn(Executor *ex, ExecTask *task, ExecFunction function);
+
+/** Coloca a tarefa parada na fila de execução, ou marca a que está executando (qualquer thread). */
+void execWake(ExecTask *task);
+
+#endif // EXECUTOR_H
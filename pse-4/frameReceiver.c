@@ -0,0 +1,45 @@
+/**
+ * @file frameReceiver.c
+ * @brief Implementação da protothread de recepção descrita em frameReceiver.h.
+ */
+#include "frameReceiver.h"
+
+void frameReceiverInit(FrameReceiver *rx, ByteRing *ring) {
+    PT_INIT(&rx->pt);
+    rx->ring = ring;
+    resetFSM(&rx->fsm);
+    rx->frameReady = false;
+    rx->frames = 0;
+    rx->errors = 0;
+}
+
+PT_THREAD(frameReceiver(FrameReceiver *rx))
+{
+    PT_BEGIN(&rx->pt);
+
+    for (;;) {
+        PT_WAIT_UNTIL(&rx->pt, !ringIsEmpty(rx->ring));
+
+        // Drena tudo o que chegou; os bytes consumidos são liberados antes de ceder a vez
+        while (!ringIsEmpty(rx->ring)) {
+            const uint8_t *data;
+            bool complete;
+            size_t len = ringReadable(rx->ring, &data);
+
+            ringConsume(rx->ring, processBuffer(&rx->fsm, data, len, &complete));
+            if (rx->fsm.currentState < STATE_COMPLETE) {
+                continue;
+            }
+            if (!complete || !checksumOk(&rx->fsm)) {
+                rx->errors++;
+                continue;
+            }
+            rx->frames++;
+            rx->frameReady = true;
+            PT_YIELD(&rx->pt);
+            rx->frameReady = false;
+        }
+    }
+
+    PT_END(&rx->pt);
+}
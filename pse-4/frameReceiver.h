@@ -0,0 +1,39 @@
+/**
+ * @file frameReceiver.h
+ * @brief Protothread de recepção de quadros (decodificador do pse-3) sobre um ByteRing.
+ *
+ * A protothread espera (PT_WAIT_UNTIL) o buffer circular deixar de estar vazio e então drena
+ * todos os bytes disponíveis de uma vez no decodificador, em trechos contíguos entregues a
+ * processBuffer. A cada quadro completo com CHK correto ela cede a vez (PT_YIELD) com
+ * frameReady verdadeiro: o chamador lê o quadro em frameData(&rx->fsm) antes de executá-la de
+ * novo. Sem bytes novos, cada execução custa só o teste do buffer vazio.
+ *
+ * Para despachar os quadros por tipo de mensagem, basta associar uma tabela à FSM
+ * (setDispatcher(&rx->fsm, ...)); os tratadores são chamados durante a drenagem.
+ */
+#ifndef FRAME_RECEIVER_H
+#define FRAME_RECEIVER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "pt-1.4/pt.h"
+#include "protocol.h"
+#include "byteRing.h"
+
+typedef struct {
+    struct pt pt;
+    ByteRing *ring;
+    FSM fsm;
+    bool frameReady;  // Quadro completo disponível em rx->fsm até a próxima execução
+    uint32_t frames;  // Quadros completos com CHK correto
+    uint32_t errors;  // Quadros terminados com erro (CHK, ETX, tamanho)
+} FrameReceiver;
+
+/** Inicializa a protothread e a FSM (modo sem escape; reconfigurável em rx->fsm). */
+void frameReceiverInit(FrameReceiver *rx, ByteRing *ring);
+
+/** Corpo da protothread; nunca termina. */
+PT_THREAD(frameReceiver(FrameReceiver *rx));
+
+#endif // FRAME_RECEIVER_H
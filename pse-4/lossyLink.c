@@ -0,0 +1,78 @@
+/**
+ * @file lossyLink.c
+ * @brief Implementação do enlace simulado descrito em lossyLink.h.
+ */
+#include <stddef.h>
+#include <string.h>
+
+#include "lossyLink.h"
+#include "ptClock.h"
+
+#define FRAME_HEADER 8 // Bytes de cabeçalho de um quadro no enlace (sequência, tamanho, tipo)
+
+static uint32_t nextRandom(LossyLink *link) {
+    uint32_t x = link->random;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return link->random = x;
+}
+
+void linkInit(LossyLink *link, uint32_t latencyMs, uint32_t bytesPerMs, unsigned lossPerMille,
+              uint32_t seed) {
+    link->head = link->tail = 0;
+    link->latencyMs = latencyMs;
+    link->bytesPerMs = bytesPerMs;
+    link->lossPerMille = lossPerMille;
+    link->random = seed != 0 ? seed : 1;
+    link->busyUntilUs = 0;
+    link->sent = link->lost = link->dropped = 0;
+}
+
+void linkSend(LossyLink *link, const ArqFrame *frame) {
+    uint64_t nowUs = (uint64_t)ptClockMs() * 1000;
+
+    link->sent++;
+    if (link->tail - link->head == LINK_QUEUE) {
+        link->dropped++;
+        return;
+    }
+    // O quadro ocupa o enlace depois do anterior, pelo tempo de serialização
+    if (link->busyUntilUs < nowUs) {
+        link->busyUntilUs = nowUs;
+    }
+    if (link->bytesPerMs > 0) {
+        link->busyUntilUs += (FRAME_HEADER + frame->length) * 1000u / link->bytesPerMs;
+    }
+    if (nextRandom(link) % 1000 < link->lossPerMille) {
+        link->lost++;
+        return;
+    }
+    unsigned slot = link->tail++ & (LINK_QUEUE - 1);
+    // Só o cabeçalho e os bytes usados: confirmações não copiam ARQ_PAYLOAD bytes
+    memcpy(&link->frames[slot], frame, offsetof(ArqFrame, data) + frame->length);
+    link->arrival[slot] = (uint32_t)((link->busyUntilUs + 999) / 1000) + link->latencyMs;
+    // O destinatário pode já ter esperado nesta volta: o laço ocioso não deve saltar a chegada
+    ptClockNoteDeadline(link->arrival[slot]);
+}
+
+bool linkReady(LossyLink *link) {
+    if (link->head == link->tail) {
+        return false;
+    }
+    uint32_t arrival = link->arrival[link->head & (LINK_QUEUE - 1)];
+    if ((int32_t)(ptClockMs() - arrival) < 0) {
+        ptClockNoteDeadline(arrival);
+        return false;
+    }
+    return true;
+}
+
+bool linkReceive(LossyLink *link, ArqFrame *frame) {
+    if (!linkReady(link)) {
+        return false;
+    }
+    const ArqFrame *arrived = &link->frames[link->head++ & (LINK_QUEUE - 1)];
+    memcpy(frame, arrived, offsetof(ArqFrame, data) + arrived->length);
+    return true;
+}
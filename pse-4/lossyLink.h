@@ -0,0 +1,49 @@
+/**
+ * @file lossyLink.h
+ * @brief Enlace simulado com atraso, taxa de transmissão e perda de quadros.
+ *
+ * Um sentido de um enlace ponto a ponto: cada quadro enviado ocupa o enlace pelo tempo de
+ * serialização (bytes / taxa), chega latencyMs depois e pode ser perdido com probabilidade
+ * lossPerMille/1000. Os quadros chegam em ordem. A fila do enlace tem LINK_QUEUE quadros; um
+ * quadro enviado com a fila cheia é descartado, como em um roteador sobrecarregado.
+ *
+ * O tempo vem de ptClockMs (ptClock.h) e as perdas de um gerador xorshift com semente própria:
+ * com o relógio virtual, a mesma semente reproduz exatamente as mesmas perdas. linkSend anota a
+ * chegada de cada quadro como prazo para ptClockIdle, e linkReady e linkReceive anotam a do próximo
+ * enquanto ele está a caminho.
+ */
+#ifndef LOSSY_LINK_H
+#define LOSSY_LINK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "arq.h"
+
+#define LINK_QUEUE 256 // Quadros a caminho (potência de 2)
+
+struct LossyLink {
+    ArqFrame frames[LINK_QUEUE];
+    uint32_t arrival[LINK_QUEUE]; // Instante (ms) de chegada de cada quadro
+    unsigned head, tail;
+    uint32_t latencyMs;
+    uint32_t bytesPerMs;          // Taxa de transmissão (0 = instantânea)
+    unsigned lossPerMille;
+    uint32_t random;              // Estado do xorshift
+    uint64_t busyUntilUs;         // Fim da serialização do último quadro (us)
+    uint64_t sent, lost, dropped; // Enviados, perdidos no enlace e descartados com a fila cheia
+};
+
+void linkInit(LossyLink *link, uint32_t latencyMs, uint32_t bytesPerMs, unsigned lossPerMille,
+              uint32_t seed);
+
+/** Coloca o quadro no enlace (ou o perde). */
+void linkSend(LossyLink *link, const ArqFrame *frame);
+
+/** Retira o próximo quadro que já chegou. Retorna false se nenhum chegou ainda. */
+bool linkReceive(LossyLink *link, ArqFrame *frame);
+
+/** Indica se há um quadro já chegado esperando linkReceive. */
+bool linkReady(LossyLink *link);
+
+#endif // LOSSY_LINK_H
@@ -0,0 +1,1211 @@
+/**
+ * @file protothreadTests.c
+ * @brief Testes dos componentes de protothreads do pse-4.
+ *
+ * Cobre o buffer circular de bytes (byteRing.c), a protothread de recepção de quadros
+ * (frameReceiver.c), o PT_SLEEP por instância (ptSleep.h), o relógio virtual (ptClock.c), o
+ * pool de instâncias (ptPool.c), as caixas de mensagens (ptMailbox.h), o perfil de execução
+ * (ptProfile.c, só com -DPT_PROFILE), a roda de temporizadores (timerWheel.c), o ARQ sobre o
+ * enlace com perdas (arq.c, lossyLink.c), a transferência com buffer duplo (bulkPipe.c), o
+ * escalonador orientado a eventos (scheduler.c), o reator de epoll (reactor.c) e o executor com
+ * roubo de trabalho (executor.c).
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "arq.h"
+#include "bulkPipe.h"
+#include "byteRing.h"
+#include "executor.h"
+#include "frameReceiver.h"
+#include "lossyLink.h"
+#include "ptClock.h"
+#include "ptMailbox.h"
+#include "ptPool.h"
+#include "ptProfile.h"
+#include "ptSleep.h"
+#include "reactor.h"
+#include "scheduler.h"
+#include "timerWheel.h"
+
+/* macros de testes - baseado em minUnit: www.jera.com/techinfo/jtns/jtn002.html */
+#define verifica(mensagem, teste) do { if (!(teste)) return mensagem; } while (0)
+#define executa_teste(teste) do { char *mensagem = teste(); testes_executados++; \
+                                if (mensagem) return mensagem; } while (0)
+
+int testes_executados = 0;
+
+/* Escritas e leituras que dão a volta no armazenamento preservam a ordem dos bytes */
+static char * testRingWrap(void) {
+    uint8_t storage[16];
+    ByteRing ring;
+    uint8_t next = 0, expected = 0;
+
+    ringInit(&ring, storage, sizeof(storage));
+    verifica("erro: buffer novo não está vazio", ringIsEmpty(&ring));
+    for (int round = 0; round < 50; round++) {
+        uint8_t chunk[11];
+        for (size_t i = 0; i < sizeof(chunk); i++) {
+            chunk[i] = next++;
+        }
+        verifica("erro: escrita parcial com espaço livre", ringWrite(&ring, chunk, sizeof(chunk)) == 11);
+        while (!ringIsEmpty(&ring)) {
+            const uint8_t *data;
+            size_t len = ringReadable(&ring, &data);
+            verifica("erro: trecho contíguo vazio", len > 0);
+            for (size_t i = 0; i < len; i++) {
+                verifica("erro: ordem dos bytes", data[i] == expected++);
+            }
+            ringConsume(&ring, len);
+        }
+    }
+
+    // Buffer cheio rejeita bytes
+    for (int i = 0; i < 16; i++) {
+        verifica("erro: byte rejeitado com espaço livre", ringPut(&ring, (uint8_t)i));
+    }
+    verifica("erro: byte aceito com o buffer cheio", !ringPut(&ring, 0));
+    verifica("erro: escrita com o buffer cheio", ringWrite(&ring, storage, 4) == 0);
+    verifica("erro: contagem com o buffer cheio", ringCount(&ring) == 16);
+    return 0;
+}
+
+/* A protothread entrega cada quadro uma vez, cedendo a vez entre eles e quando falta byte */
+static char * testFrameReceiver(void) {
+    uint8_t storage[64];
+    uint8_t stream[4 * MAX_FRAME_SIZE];
+    ByteRing ring;
+    FrameReceiver rx;
+    size_t n = 0, pos = 0;
+    int received = 0;
+
+    n += encodeFrame((const uint8_t *)"primeiro", 8, stream + n, false);
+    n += encodeFrame((const uint8_t *)"ruim", 4, stream + n, false);
+    stream[n - 2] ^= 1; // CHK corrompido
+    n += encodeFrame((const uint8_t *)"", 0, stream + n, false);
+    n += encodeFrame((const uint8_t *)"terceiro quadro, maior que o buffer circular de 64 bytes.....",
+                     61, stream + n, false);
+
+    ringInit(&ring, storage, sizeof(storage));
+    frameReceiverInit(&rx, &ring);
+    verifica("erro: receptor sem bytes deveria esperar", frameReceiver(&rx) == PT_WAITING);
+
+    // Bytes chegam em pedaços de tamanhos variados, como de uma interrupção
+    for (int step = 0; received < 3 && step < 1000; step++) {
+        if (pos < n) {
+            size_t chunk = 1 + (size_t)step % 23;
+            pos += ringWrite(&ring, stream + pos, chunk < n - pos ? chunk : n - pos);
+        }
+        while (frameReceiver(&rx) == PT_YIELDED) {
+            verifica("erro: rendimento sem quadro", rx.frameReady);
+            const uint8_t *data = frameData(&rx.fsm);
+            switch (received++) {
+                case 0:
+                    verifica("erro: primeiro quadro", rx.fsm.qtd == 8 && memcmp(data, "primeiro", 8) == 0);
+                    break;
+                case 1:
+                    verifica("erro: quadro vazio", rx.fsm.qtd == 0);
+                    break;
+                default:
+                    verifica("erro: terceiro quadro", rx.fsm.qtd == 61 && memcmp(data, "terceiro", 8) == 0);
+                    break;
+            }
+        }
+        verifica("erro: quadro pendente após a espera", !rx.frameReady);
+    }
+    verifica("erro: quadros recebidos", received == 3 && rx.frames == 3);
+    verifica("erro: quadro com CHK incorreto não contado", rx.errors == 1);
+    verifica("erro: bytes não drenados", ringIsEmpty(&ring));
+    return 0;
+}
+
+/* Muitas instâncias da mesma protothread dormem ao mesmo tempo, cada uma com o seu prazo */
+#define NAPPERS 200
+
+typedef struct {
+    TimedPt tpt;
+    uint32_t ms, start, woke;
+} Napper;
+
+static PT_THREAD(napper(Napper *self))
+{
+    PT_BEGIN(&self->tpt.pt);
+    self->start = ptClockMs();
+    PT_SLEEP(&self->tpt, self->ms);
+    self->woke = ptClockMs();
+    PT_END(&self->tpt.pt);
+}
+
+static char * testPtSleepInstances(void) {
+    static Napper nappers[NAPPERS];
+    bool done[NAPPERS] = {false};
+    int live = NAPPERS;
+
+    for (int i = 0; i < NAPPERS; i++) {
+        PT_INIT(&nappers[i].tpt.pt);
+        nappers[i].ms = 2 * (uint32_t)(NAPPERS - i) / 10; // De 40 ms a 0
+    }
+    while (live > 0) {
+        for (int i = 0; i < NAPPERS; i++) {
+            if (!done[i] && !PT_SCHEDULE(napper(&nappers[i]))) {
+                done[i] = true;
+                live--;
+            }
+        }
+    }
+    for (int i = 0; i < NAPPERS; i++) {
+        verifica("erro: acordou antes do próprio prazo", nappers[i].woke - nappers[i].start >= nappers[i].ms);
+        verifica("erro: prazo de outra instância", nappers[i].woke - nappers[i].start < nappers[i].ms + 20);
+    }
+    return 0;
+}
+
+/* Instâncias da mesma protothread, alocadas do pool, decodificam quadros independentes */
+#define HANDLERS 100
+
+PT_CONTEXT(Handler,
+    const uint8_t *stream;
+    size_t length, position;
+    FSM fsm;
+    uint8_t payloadLength;
+    bool ok;
+);
+
+static PT_THREAD(handler(struct pt *pt))
+{
+    Handler *self = PT_SELF(Handler, pt);
+
+    PT_BEGIN(pt);
+    resetFSM(&self->fsm);
+    // Um byte por execução: o estado que atravessa o PT_YIELD fica no contexto
+    while (self->position < self->length) {
+        if (processByte(&self->fsm, self->stream[self->position++])) {
+            self->ok = frameStatus(&self->fsm) == FRAME_OK &&
+                       self->fsm.qtd == self->payloadLength;
+        }
+        PT_YIELD(pt);
+    }
+    PT_END(pt);
+}
+
+static char * testPtPool(void) {
+    static Handler handlers[HANDLERS];
+    static uint64_t used[PT_POOL_WORDS(HANDLERS)];
+    static uint8_t streams[HANDLERS][MAX_FRAME_SIZE];
+    Handler *spawned[HANDLERS];
+    PtPool pool;
+    uint8_t payload[32];
+    unsigned passes = 0;
+
+    memset(payload, 'x', sizeof(payload));
+    ptPoolInit(&pool, handlers, sizeof(handlers[0]), HANDLERS, used);
+    for (int i = 0; i < HANDLERS; i++) {
+        Handler *h = ptPoolAlloc(&pool);
+        verifica("erro: pool cheio antes da capacidade", h != NULL);
+        verifica("erro: índice da instância", ptPoolIndex(&pool, h) == (unsigned)i);
+        h->payloadLength = (uint8_t)(i % 32);
+        h->length = encodeFrame(payload, h->payloadLength, streams[i], false);
+        h->stream = streams[i];
+        spawned[i] = h;
+    }
+    verifica("erro: alocação além da capacidade", ptPoolAlloc(&pool) == NULL);
+
+    while (ptPoolRun(&pool, handler) > 0) {
+        passes++;
+    }
+    for (int i = 0; i < HANDLERS; i++) {
+        verifica("erro: quadro da instância", spawned[i]->ok);
+    }
+    // O quadro mais longo (31 bytes de dados + 4) determina as passadas
+    verifica("erro: número de passadas", passes == 35);
+
+    // Instâncias terminadas são liberadas e reaproveitadas a partir do menor índice
+    verifica("erro: pool não esvaziou", pool.count == 0);
+    Handler *h = ptPoolAlloc(&pool);
+    verifica("erro: reaproveitamento da posição", h == &handlers[0] && h->position == 0);
+    ptPoolFree(&pool, h);
+    verifica("erro: contagem após liberar", pool.count == 0);
+    return 0;
+}
+
+/* Instâncias alocadas de dentro de uma passada: as de índice maior rodam nela, as de índice
+ * menor ficam para a próxima (inclusive em outra palavra do mapa de bits) */
+#define SPAWNED 80
+
+PT_CONTEXT(Spawner,
+    PtPool *pool;
+    bool started;
+);
+
+static PT_THREAD(spawner(struct pt *pt))
+{
+    Spawner *self = PT_SELF(Spawner, pt);
+
+    PT_BEGIN(pt);
+    self->started = true;
+    if (self->pool != NULL) {
+        // Ocupa o índice 0, liberado antes da passada, e depois os índices 2 a 64
+        Spawner *child;
+        do {
+            child = ptPoolAlloc(self->pool);
+        } while (ptPoolIndex(self->pool, child) < 64);
+    }
+    PT_WAIT_UNTIL(pt, false);
+    PT_END(pt);
+}
+
+static char * testPtPoolSpawn(void) {
+    static Spawner spawners[SPAWNED];
+    static uint64_t used[PT_POOL_WORDS(SPAWNED)];
+    PtPool pool;
+
+    ptPoolInit(&pool, spawners, sizeof(spawners[0]), SPAWNED, used);
+    Spawner *first = ptPoolAlloc(&pool);
+    Spawner *parent = ptPoolAlloc(&pool);
+    ptPoolFree(&pool, first);
+    parent->pool = &pool;
+
+    verifica("erro: instâncias ocupadas após a passada", ptPoolRun(&pool, spawner) == 65);
+    verifica("erro: índice anterior rodou na mesma passada", !spawners[0].started);
+    for (int i = 1; i <= 64; i++) {
+        verifica("erro: índice posterior ficou para a próxima passada", spawners[i].started);
+    }
+    ptPoolRun(&pool, spawner);
+    verifica("erro: índice anterior não rodou na passada seguinte", spawners[0].started);
+    verifica("erro: instância livre executada", !spawners[65].started);
+    return 0;
+}
+
+/* Produtor -> filtro -> consumidor em lote: itens chegam em ordem, sem perdas nem duplicatas */
+#define PIPELINE_ITEMS 1000
+#define BATCH_MAX      16
+
+PT_MAILBOX(ItemBox, uint32_t, 8);
+
+typedef struct {
+    ItemBox raw, doubled;
+    uint32_t produced, filtered, item;
+    uint32_t consumed, consumerRuns;
+    bool ordered;
+} Pipeline;
+
+static PT_THREAD(pipeProducer(struct pt *pt, Pipeline *p))
+{
+    PT_BEGIN(pt);
+    while (p->produced < PIPELINE_ITEMS) {
+        PT_MBOX_SEND(pt, &p->raw, p->produced);
+        p->produced++;
+        if (p->produced % 5 == 0) {
+            PT_YIELD(pt); // Rajadas de 5 itens
+        }
+    }
+    PT_END(pt);
+}
+
+static PT_THREAD(pipeFilter(struct pt *pt, Pipeline *p))
+{
+    PT_BEGIN(pt);
+    while (p->filtered < PIPELINE_ITEMS) {
+        PT_MBOX_RECV(pt, &p->raw, p->item);
+        PT_MBOX_SEND(pt, &p->doubled, 2 * p->item);
+        p->filtered++;
+    }
+    PT_END(pt);
+}
+
+static PT_THREAD(pipeConsumer(struct pt *pt, Pipeline *p))
+{
+    uint32_t batch[BATCH_MAX];
+    unsigned n;
+
+    PT_BEGIN(pt);
+    while (p->consumed < PIPELINE_ITEMS) {
+        PT_MBOX_RECV_BATCH(pt, &p->doubled, batch, BATCH_MAX, n);
+        for (unsigned i = 0; i < n; i++) {
+            p->ordered &= batch[i] == 2 * (p->consumed + i);
+        }
+        p->consumed += n;
+        p->consumerRuns++;
+    }
+    PT_END(pt);
+}
+
+static char * testPtMailbox(void) {
+    static Pipeline p;
+    struct pt producer, filter, consumer;
+    bool running = true;
+
+    PT_MBOX_INIT(&p.raw);
+    PT_MBOX_INIT(&p.doubled);
+    p.ordered = true;
+    PT_INIT(&producer);
+    PT_INIT(&filter);
+    PT_INIT(&consumer);
+    verifica("erro: capacidade da caixa", PT_MBOX_CAPACITY(&p.raw) == 8);
+
+    while (running) {
+        running = PT_SCHEDULE(pipeProducer(&producer, &p));
+        running |= PT_SCHEDULE(pipeFilter(&filter, &p));
+        running |= PT_SCHEDULE(pipeConsumer(&consumer, &p));
+        verifica("erro: caixa além da capacidade", PT_MBOX_COUNT(&p.raw) <= 8 && PT_MBOX_COUNT(&p.doubled) <= 8);
+    }
+    verifica("erro: itens perdidos ou fora de ordem", p.consumed == PIPELINE_ITEMS && p.ordered);
+    verifica("erro: caixas não esvaziaram", PT_MBOX_EMPTY(&p.raw) && PT_MBOX_EMPTY(&p.doubled));
+    verifica("erro: consumidor não recebeu em lote", p.consumerRuns < PIPELINE_ITEMS / 2);
+
+    // Índices que dão a volta no contador sem sinal
+    p.raw.head = p.raw.tail = UINT32_MAX - 2;
+    for (uint32_t i = 0; i < 8; i++) {
+        PT_MBOX_SLOT(&p.raw, p.raw.head) = i;
+        p.raw.head++;
+    }
+    verifica("erro: cheia após a volta do índice", PT_MBOX_FULL(&p.raw));
+    for (uint32_t i = 0; i < 8; i++) {
+        verifica("erro: ordem após a volta do índice", PT_MBOX_SLOT(&p.raw, p.raw.tail) == i);
+        p.raw.tail++;
+    }
+    return 0;
+}
+
+#ifdef PT_PROFILE
+/* O perfil separa esperas inúteis (mesma espera, sem progresso) de yields e de progresso */
+static PT_THREAD(profiled(struct pt *pt, const bool *ready))
+{
+    PT_BEGIN(pt);
+    PT_YIELD(pt);
+    PT_WAIT_UNTIL(pt, *ready);
+    PT_YIELD(pt);
+    PT_END(pt);
+}
+
+static char * testPtProfile(void) {
+    static PtProfile profile = PT_PROFILE_INIT("profiled");
+    struct pt pt;
+    bool ready = false;
+    int runs = 0;
+
+    PT_INIT(&pt);
+    while (PT_PROFILE_SCHEDULE(&profile, &pt, profiled(&pt, &ready))) {
+        if (++runs == 12) {
+            ready = true;
+        }
+    }
+    // 1: yield; 2: chega à espera (progresso); 3 a 12: espera inútil; 13: yield; 14: fim
+    verifica("erro: execuções contadas", profile.invocations == 14);
+    verifica("erro: esperas inúteis", profile.wastedPolls == 10);
+    verifica("erro: yields", profile.yields == 2);
+    verifica("erro: términos", profile.exits == 1);
+    verifica("erro: tempo de execução", profile.runNs > 0);
+
+    ptProfileReset();
+    verifica("erro: contadores não zerados", profile.invocations == 0 && profile.runNs == 0);
+    return 0;
+}
+
+/* Um laço que consome um item por execução volta sempre à mesma espera, mas progride */
+#define PROFILED_ITEMS 100
+
+static PT_THREAD(profiledLoop(struct pt *pt, unsigned *available, unsigned *taken))
+{
+    PT_BEGIN(pt);
+    while (*taken < PROFILED_ITEMS) {
+        PT_WAIT_UNTIL(pt, *available > 0);
+        (*available)--;
+        (*taken)++;
+    }
+    PT_END(pt);
+}
+
+static char * testPtProfileLoop(void) {
+    static PtProfile profile = PT_PROFILE_INIT("profiledLoop");
+    struct pt pt;
+    unsigned available = 0, taken = 0;
+    int runs = 0;
+
+    PT_INIT(&pt);
+    do {
+        // Um item por execução, exceto em 5 execuções no meio
+        available = runs < 50 || runs >= 55 ? 1 : 0;
+        runs++;
+    } while (PT_PROFILE_SCHEDULE(&profile, &pt, profiledLoop(&pt, &available, &taken)));
+
+    verifica("erro: execuções do laço", profile.invocations == PROFILED_ITEMS + 5);
+    verifica("erro: execução com progresso contada como inútil", profile.wastedPolls == 5);
+    verifica("erro: término do laço", profile.exits == 1);
+    return 0;
+}
+#endif
+
+/* Temporizadores do teste da roda */
+#define WHEEL_TIMERS 5000
+
+typedef struct {
+    TimerEntry entry;
+    int fired;
+} TestTimer;
+
+typedef struct {
+    uint32_t from, to; // Faixa de ticks do timerAdvance atual
+    bool inRange;
+} AdvanceCheck;
+
+static void fireTestTimer(TimerEntry *entry, void *context) {
+    AdvanceCheck *check = context;
+    TestTimer *timer = (TestTimer *)entry;
+    timer->fired++;
+    check->inRange &= (int32_t)(entry->expires - check->from) > 0 &&
+                      (int32_t)(check->to - entry->expires) >= 0;
+}
+
+/* Cada temporizador vence uma vez, no timerAdvance que passa pelo seu prazo */
+static char * testTimerWheel(void) {
+    static TestTimer timers[WHEEL_TIMERS];
+    static TimerWheel wheel;
+    AdvanceCheck check = {.inRange = true};
+    uint32_t now = 0xfffff000u; // Perto da volta do contador de 32 bits
+    int removed = 0;
+
+    srand(7);
+    timerWheelInit(&wheel, now);
+    for (int i = 0; i < WHEEL_TIMERS; i++) {
+        timerInit(&timers[i].entry);
+        timers[i].fired = 0;
+        // Prazos curtos e longos, para passar por todos os níveis
+        uint32_t delay = (uint32_t)rand() % (i % 4 == 0 ? 2000000 : 3000);
+        timerAdd(&wheel, &timers[i].entry, now + delay);
+    }
+    for (int i = 0; i < WHEEL_TIMERS; i += 7) {
+        timerRemove(&wheel, &timers[i].entry);
+        removed++;
+    }
+    verifica("erro: contagem de temporizadores", wheel.count == (unsigned)(WHEEL_TIMERS - removed));
+
+    while (wheel.count > 0) {
+        uint32_t step = 1 + (uint32_t)rand() % (rand() % 2 ? 50 : 20000);
+        uint32_t limit = timerNextExpiry(&wheel);
+        verifica("erro: próximo prazo no passado", (int32_t)(limit - now) > 0);
+        check.from = now;
+        check.to = now += step;
+        timerAdvance(&wheel, now, fireTestTimer, &check);
+        verifica("erro: temporizador vencido fora do seu intervalo", check.inRange);
+    }
+    for (int i = 0; i < WHEEL_TIMERS; i++) {
+        verifica("erro: temporizador vencido zero ou mais de uma vez",
+                 timers[i].fired == (i % 7 == 0 ? 0 : 1));
+    }
+    return 0;
+}
+
+/* Produtor e consumidor alternados por dois semáforos */
+#define PING_PONGS 1000
+
+typedef struct {
+    Task task;
+    Semaphore *wait, *signal;
+    int count;
+} PingPong;
+
+static PT_THREAD(pingPong(Task *task))
+{
+    PingPong *self = (PingPong *)task;
+
+    PT_BEGIN(&task->pt);
+    while (self->count < PING_PONGS) {
+        PT_SEM_ACQUIRE(task, self->wait);
+        self->count++;
+        semaphoreSignal(self->signal);
+    }
+    PT_END(&task->pt);
+}
+
+/* Tarefas bloqueadas não são reexecutadas: cada troca custa uma execução por tarefa */
+static char * testSchedulerSemaphore(void) {
+    Scheduler scheduler;
+    Semaphore ping, pong;
+    PingPong a, b;
+
+    schedulerInit(&scheduler);
+    semaphoreInit(&ping, &scheduler, 1);
+    semaphoreInit(&pong, &scheduler, 0);
+    a = (PingPong){.wait = &ping, .signal = &pong};
+    b = (PingPong){.wait = &pong, .signal = &ping};
+    taskSpawn(&scheduler, &a.task, pingPong);
+    taskSpawn(&scheduler, &b.task, pingPong);
+#ifdef PT_PROFILE
+    static PtProfile profile = PT_PROFILE_INIT("pingPong");
+    a.task.profile = b.task.profile = &profile;
+#endif
+    schedulerRun(&scheduler);
+
+    verifica("erro: trocas incompletas", a.count == PING_PONGS && b.count == PING_PONGS);
+    verifica("erro: tarefas reexecutadas sem evento", scheduler.runs <= 2 * PING_PONGS + 4);
+#ifdef PT_PROFILE
+    // Cada execução acordada pelo semáforo adquire antes de voltar à mesma espera
+    verifica("erro: execuções acordadas contadas como inúteis", profile.wastedPolls == 0);
+#endif
+    schedulerDestroy(&scheduler);
+    return 0;
+}
+
+typedef struct {
+    Task task;
+    Semaphore *sem;
+} Acquirer;
+
+static PT_THREAD(acquireOnce(Task *task))
+{
+    Acquirer *self = (Acquirer *)task;
+
+    PT_BEGIN(&task->pt);
+    PT_SEM_ACQUIRE(task, self->sem);
+    PT_END(&task->pt);
+}
+
+/* Uma tarefa acordada por taskWake que já encontra o semáforo positivo sai da lista de espera:
+ * o semaphoreSignal seguinte chega a quem ainda espera */
+static char * testSchedulerEarlyWake(void) {
+    Scheduler scheduler;
+    Semaphore sem;
+    Acquirer early, waiter;
+
+    schedulerInit(&scheduler);
+    semaphoreInit(&sem, &scheduler, 0);
+    early = (Acquirer){.sem = &sem};
+    waiter = (Acquirer){.sem = &sem};
+    taskSpawn(&scheduler, &early.task, acquireOnce);
+    taskSpawn(&scheduler, &waiter.task, acquireOnce);
+    schedulerRunReady(&scheduler);
+    verifica("erro: tarefas não registradas", sem.event.waiters == &early.task);
+
+    atomic_fetch_add(&sem.count, 1);
+    taskWake(&early.task);
+    schedulerRunReady(&scheduler);
+    verifica("erro: tarefa acordada não adquiriu", early.task.flags & TASK_DONE);
+    verifica("erro: registro não cancelado", sem.event.waiters == &waiter.task);
+
+    semaphoreSignal(&sem);
+    schedulerRunReady(&scheduler);
+    verifica("erro: sinal gasto com a tarefa já acordada", waiter.task.flags & TASK_DONE);
+    schedulerDestroy(&scheduler);
+    return 0;
+}
+
+typedef struct {
+    Task task;
+    uint32_t ms;
+    int *order, *position;
+} Sleeper;
+
+static PT_THREAD(sleeper(Task *task))
+{
+    Sleeper *self = (Sleeper *)task;
+
+    PT_BEGIN(&task->pt);
+    PT_SLEEP_MS(task, self->ms);
+    self->order[(*self->position)++] = (int)self->ms;
+    PT_END(&task->pt);
+}
+
+/* Tarefas dormindo acordam em ordem de prazo, uma vez cada, sem consumir CPU na espera */
+static char * testSchedulerSleep(void) {
+    static const uint32_t delays[] = {120, 40, 80};
+    Scheduler scheduler;
+    Sleeper sleepers[3];
+    int order[3], position = 0;
+
+    schedulerInit(&scheduler);
+    for (int i = 0; i < 3; i++) {
+        sleepers[i] = (Sleeper){.ms = delays[i], .order = order, .position = &position};
+        taskSpawn(&scheduler, &sleepers[i].task, sleeper);
+    }
+    uint32_t start = schedulerNow();
+    clock_t cpu = clock();
+    schedulerRun(&scheduler);
+    cpu = clock() - cpu;
+    uint32_t elapsed = schedulerNow() - start;
+
+    verifica("erro: ordem de acordar", position == 3 && order[0] == 40 && order[1] == 80 && order[2] == 120);
+    verifica("erro: acordou antes do prazo", elapsed >= 120);
+    verifica("erro: tarefas executadas mais de duas vezes", scheduler.runs == 6);
+    verifica("erro: CPU consumida na espera", cpu < CLOCKS_PER_SEC / 50);
+    schedulerDestroy(&scheduler);
+    return 0;
+}
+
+/* Duas horas de tráfego periódico com o relógio virtual: laço de varredura e escalonador */
+#define SIM_END      (2u * 60 * 60 * 1000)
+#define SIM_THREADS  50
+
+typedef struct {
+    TimedPt tpt;
+    uint32_t period;
+    unsigned sent;
+} Periodic;
+
+static PT_THREAD(periodic(Periodic *self))
+{
+    PT_BEGIN(&self->tpt.pt);
+    while (ptClockMs() < SIM_END) {
+        PT_SLEEP(&self->tpt, self->period);
+        self->sent++;
+    }
+    PT_END(&self->tpt.pt);
+}
+
+/* Executa a simulação e retorna as voltas do laço; sent de cada protothread fica em all */
+static unsigned simulatePeriodic(Periodic *all) {
+    unsigned passes = 0;
+    int live = SIM_THREADS;
+    bool done[SIM_THREADS] = {false};
+
+    ptClockSimulate(0);
+    for (int i = 0; i < SIM_THREADS; i++) {
+        all[i] = (Periodic){.period = 100 + 37 * (uint32_t)i};
+        PT_INIT(&all[i].tpt.pt);
+    }
+    while (live > 0) {
+        for (int i = 0; i < SIM_THREADS; i++) {
+            if (!done[i] && !PT_SCHEDULE(periodic(&all[i]))) {
+                done[i] = true;
+                live--;
+            }
+        }
+        passes++;
+        if (live > 0) {
+            ptClockIdle(60000);
+        }
+    }
+    return passes;
+}
+
+typedef struct {
+    Task task;
+    uint32_t period;
+    unsigned ticks;
+} SimTask;
+
+static PT_THREAD(simTask(Task *task))
+{
+    SimTask *self = (SimTask *)task;
+
+    PT_BEGIN(&task->pt);
+    while (schedulerNow() < SIM_END) {
+        PT_SLEEP_MS(task, self->period);
+        self->ticks++;
+    }
+    PT_END(&task->pt);
+}
+
+static char * testPtClockSimulated(void) {
+    static Periodic first[SIM_THREADS], replay[SIM_THREADS];
+    SimTask tasks[4];
+    Scheduler scheduler;
+    unsigned expected = 0, ticks = 0;
+
+    unsigned passes = simulatePeriodic(first);
+    verifica("erro: tempo simulado", ptClockMs() >= SIM_END && ptClockMs() < SIM_END + 100 + 37 * SIM_THREADS);
+    for (int i = 0; i < SIM_THREADS; i++) {
+        // Cada prazo vence exatamente no instante simulado: ceil(SIM_END / período) envios
+        verifica("erro: envios de uma protothread", first[i].sent == (SIM_END + first[i].period - 1) / first[i].period);
+    }
+    verifica("erro: simulação não reproduzida", simulatePeriodic(replay) == passes &&
+             memcmp(first, replay, sizeof(first)) == 0);
+
+    // Escalonador: o ocioso salta até o próximo prazo da roda de temporizadores
+    ptClockSimulate(0);
+    schedulerInit(&scheduler);
+    for (int i = 0; i < 4; i++) {
+        tasks[i] = (SimTask){.period = 1000 * (uint32_t)(i + 1)};
+        taskSpawn(&scheduler, &tasks[i].task, simTask);
+        expected += (SIM_END + tasks[i].period - 1) / tasks[i].period;
+    }
+    schedulerRun(&scheduler);
+    for (int i = 0; i < 4; i++) {
+        ticks += tasks[i].ticks;
+    }
+    verifica("erro: prazos do escalonador simulado", ticks == expected && schedulerNow() >= SIM_END);
+    verifica("erro: escalonador dormiu de verdade", scheduler.runs == expected + 4);
+    schedulerDestroy(&scheduler);
+    ptClockReal();
+    return 0;
+}
+
+/* ARQ com 10% de perda nos dois sentidos: entrega em ordem, uma vez, e RTO adaptado ao enlace */
+#define ARQ_FRAMES 300
+
+typedef struct {
+    uint32_t delivered;
+    bool ordered;
+} ArqSink;
+
+static uint16_t arqFill(void *context, uint32_t seq, uint8_t *data) {
+    (void)context;
+    uint16_t length = (uint16_t)(1 + seq % ARQ_PAYLOAD);
+    for (uint16_t i = 0; i < length; i++) {
+        data[i] = (uint8_t)(seq + i);
+    }
+    return length;
+}
+
+static void arqDeliver(void *context, uint32_t seq, const uint8_t *data, uint16_t length) {
+    ArqSink *sink = context;
+    bool valid = seq == sink->delivered && length == 1 + seq % ARQ_PAYLOAD;
+    for (uint16_t i = 0; valid && i < length; i++) {
+        valid = data[i] == (uint8_t)(seq + i);
+    }
+    sink->ordered &= valid;
+    sink->delivered++;
+}
+
+static char * testArq(void) {
+    static ArqSender sender;
+    static ArqReceiver receiver;
+    static LossyLink data, acks;
+    uint64_t retransmissions[2];
+
+    for (int i = 0; i < 2; i++) {
+        ArqMode mode = i == 0 ? ARQ_GO_BACK_N : ARQ_SELECTIVE_REPEAT;
+        ArqSink sink = {.delivered = 0, .ordered = true};
+        unsigned passes = 0;
+
+        ptClockSimulate(0);
+        linkInit(&data, 20, 100, 100, 7);
+        linkInit(&acks, 20, 100, 100, 11);
+        arqSenderInit(&sender, mode, 8, &data, &acks, ARQ_FRAMES, arqFill, NULL, 3000, 50);
+        arqReceiverInit(&receiver, mode, 8, &data, &acks, ARQ_FRAMES, arqDeliver, &sink);
+        while (PT_SCHEDULE(arqSenderRun(&sender)) && passes++ < 100000) {
+            (void)PT_SCHEDULE(arqReceiverRun(&receiver));
+            ptClockIdle(60000);
+        }
+        verifica("erro: transmissor não terminou", passes < 100000);
+        verifica("erro: entrega fora de ordem ou corrompida", sink.ordered && arqReceiverDone(&receiver));
+        verifica("erro: quadro entregue mais de uma vez", sink.delivered == ARQ_FRAMES);
+        verifica("erro: perdas sem retransmissão", data.lost > 0 && sender.retransmissions > 0);
+        // RTT de 40 ms mais a serialização: o RTO sai dos 3 s iniciais
+        verifica("erro: RTO não adaptado", sender.rttSamples > 0 && sender.rto < 1000);
+        retransmissions[i] = sender.retransmissions;
+    }
+    ptClockReal();
+    verifica("erro: repetição seletiva reenviou mais que Go-Back-N", retransmissions[1] < retransmissions[0]);
+    return 0;
+}
+
+/* Buffer duplo: tamanho que não fecha o último bloco, origem desalinhada e dado corrompido */
+#define BULK_TOTAL (3 * BULK_BLOCK + 13)
+
+static char * testBulkPipe(void) {
+    static BulkPipe pipe;
+    static int dst[BULK_TOTAL];
+    uint8_t frame[1 + 37 * sizeof(int)];
+    int copy[37];
+    unsigned passes = 0;
+
+    bulkPipeInit(&pipe, dst, BULK_TOTAL, 1000);
+    while (PT_SCHEDULE(bulkConsumer(&pipe)) && passes++ < 100) {
+        (void)PT_SCHEDULE(bulkProducer(&pipe));
+        verifica("erro: produtor passou o consumidor em mais de dois blocos", pipe.filled - pipe.drained <= 2);
+    }
+    verifica("erro: transferência não terminou", passes < 100 && pipe.consumed == BULK_TOTAL);
+    verifica("erro: blocos válidos rejeitados", pipe.valid && pipe.filled == 4 && pipe.drained == 4);
+    for (int i = 0; i < BULK_TOTAL; i++) {
+        verifica("erro: destino incorreto", dst[i] == 1000 + i);
+    }
+
+    // Dados de um quadro, fora do alinhamento de int
+    bulkFill(frame + 1, 37, -5);
+    verifica("erro: cópia válida rejeitada", bulkCopyValidate(copy, frame + 1, 37, -5));
+    verifica("erro: cópia incompleta", copy[0] == -5 && copy[36] == 31);
+    frame[1 + 35 * sizeof(int)] ^= 0x10;
+    verifica("erro: dado corrompido aceito", !bulkCopyValidate(copy, frame + 1, 37, -5));
+    verifica("erro: cópia não seguiu até o fim", copy[36] == 31);
+    return 0;
+}
+
+/* Bytes escritos por outra thread acordam a tarefa pelo evento de chegada */
+#define ARRIVAL_BYTES 20000
+
+typedef struct {
+    Task task;
+    ByteRing *ring;
+    Event *arrival;
+    size_t received;
+    bool ordered;
+} Drainer;
+
+static PT_THREAD(drainer(Task *task))
+{
+    Drainer *self = (Drainer *)task;
+
+    PT_BEGIN(&task->pt);
+    while (self->received < ARRIVAL_BYTES) {
+        PT_WAIT_EVENT(task, self->arrival, !ringIsEmpty(self->ring));
+        const uint8_t *data;
+        size_t len = ringReadable(self->ring, &data);
+        for (size_t i = 0; i < len; i++) {
+            self->ordered &= data[i] == (uint8_t)(self->received + i);
+        }
+        self->received += len;
+        ringConsume(self->ring, len);
+    }
+    PT_END(&task->pt);
+}
+
+typedef struct {
+    ByteRing *ring;
+    Event *arrival;
+} Producer;
+
+static void * produce(void *arg) {
+    Producer *producer = arg;
+    for (size_t sent = 0; sent < ARRIVAL_BYTES;) {
+        uint8_t byte = (uint8_t)sent;
+        if (ringPut(producer->ring, byte)) {
+            sent++;
+            if (sent % 100 == 0) {
+                eventPost(producer->arrival); // Como uma interrupção a cada rajada
+            }
+        }
+    }
+    eventPost(producer->arrival);
+    return NULL;
+}
+
+static char * testSchedulerCrossThread(void) {
+    static uint8_t storage[256];
+    Scheduler scheduler;
+    ByteRing ring;
+    Event arrival;
+    Drainer d = {.received = 0, .ordered = true};
+    Producer producer = {&ring, &arrival};
+    pthread_t thread;
+
+    schedulerInit(&scheduler);
+    ringInit(&ring, storage, sizeof(storage));
+    eventInit(&arrival, &scheduler);
+    d.ring = &ring;
+    d.arrival = &arrival;
+    taskSpawn(&scheduler, &d.task, drainer);
+    pthread_create(&thread, NULL, produce, &producer);
+    schedulerRun(&scheduler);
+    pthread_join(thread, NULL);
+
+    verifica("erro: bytes perdidos entre threads", d.received == ARRIVAL_BYTES && d.ordered);
+    schedulerDestroy(&scheduler);
+    return 0;
+}
+
+/* Tarefas esperando um socket só executam quando ele fica pronto para leitura/escrita */
+#define REACTOR_MESSAGES 50
+
+typedef struct {
+    Task task;
+    int fd;
+    unsigned received;
+    bool blockedOnWrite;
+} SocketTask;
+
+static PT_THREAD(socketReader(Task *task))
+{
+    SocketTask *self = (SocketTask *)task;
+    char byte;
+
+    PT_BEGIN(&task->pt);
+    while (self->received < REACTOR_MESSAGES) {
+        ssize_t n = read(self->fd, &byte, 1);
+        if (n < 0 && errno == EAGAIN) {
+            PT_WAIT_READABLE(task, self->fd);
+            continue;
+        }
+        self->received += n == 1;
+    }
+    // Enche o buffer do socket e espera o outro lado esvaziá-lo
+    while (write(self->fd, "x", 1) == 1) {
+    }
+    self->blockedOnWrite = true;
+    PT_WAIT_WRITABLE(task, self->fd);
+    PT_END(&task->pt);
+}
+
+static void * socketPeer(void *arg) {
+    int fd = *(int *)arg;
+    char buf[4096];
+
+    for (int i = 0; i < REACTOR_MESSAGES; i++) {
+        nanosleep(&(struct timespec){ .tv_nsec = 200000 }, NULL);
+        if (write(fd, "m", 1) != 1) {
+            return NULL;
+        }
+    }
+    // Esvazia o que o leitor escrever até ele terminar
+    while (read(fd, buf, sizeof(buf)) > 0) {
+    }
+    return NULL;
+}
+
+/* Espera um descritor que o epoll recusa: cede a vez a cada espera em vez de seguir direto */
+static PT_THREAD(refusedWaiter(Task *task))
+{
+    SocketTask *self = (SocketTask *)task;
+
+    PT_BEGIN(&task->pt);
+    while (self->received < 3) {
+        PT_WAIT_READABLE(task, self->fd);
+        self->received++;
+    }
+    PT_END(&task->pt);
+}
+
+static char * testReactor(void) {
+    Scheduler scheduler;
+    Reactor reactor;
+    SocketTask reader = {.received = 0, .blockedOnWrite = false};
+    SocketTask refused = {.received = 0};
+    int fds[2];
+    pthread_t thread;
+    FILE *file;
+
+    verifica("erro: socketpair", socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    fcntl(fds[0], F_SETFL, O_NONBLOCK);
+    schedulerInit(&scheduler);
+    verifica("erro: criação do epoll", reactorInit(&reactor, &scheduler));
+    reader.fd = fds[0];
+    taskSpawn(&scheduler, &reader.task, socketReader);
+    pthread_create(&thread, NULL, socketPeer, &fds[1]);
+    schedulerRun(&scheduler);
+    shutdown(fds[1], SHUT_RDWR);
+    pthread_join(thread, NULL);
+
+    verifica("erro: mensagens perdidas", reader.received == REACTOR_MESSAGES && reader.blockedOnWrite);
+    // Uma execução por mensagem (no máximo), mais a espera de escrita: nenhuma varredura
+    verifica("erro: tarefa executada sem o descritor pronto", scheduler.runs <= REACTOR_MESSAGES + 3);
+    verifica("erro: eventos do reator", reactor.events >= 2 && reactor.events <= REACTOR_MESSAGES + 2);
+    reactorForget(&reactor, fds[0]);
+    reactorDestroy(&reactor);
+    schedulerDestroy(&scheduler);
+    close(fds[0]);
+    close(fds[1]);
+
+    // Arquivo comum: epoll_ctl falha com EPERM e PT_WAIT_READABLE vira PT_YIELD
+    file = tmpfile();
+    verifica("erro: tmpfile", file != NULL);
+    schedulerInit(&scheduler);
+    verifica("erro: criação do epoll", reactorInit(&reactor, &scheduler));
+    refused.fd = fileno(file);
+    taskSpawn(&scheduler, &refused.task, refusedWaiter);
+    schedulerRun(&scheduler);
+    verifica("erro: espera recusada não cedeu a vez", refused.received == 3 && scheduler.runs == 4);
+    reactorDestroy(&reactor);
+    schedulerDestroy(&scheduler);
+    fclose(file);
+    return 0;
+}
+
+/* Árvore de tarefas: cada nó interno cria 3 filhas e soma os valores que elas entregam */
+#define JOIN_FANOUT 3
+#define JOIN_NODES  40 // 4 níveis: 13 nós internos e 27 folhas
+#define JOIN_LEAVES 27
+
+typedef struct {
+    Task task;
+    unsigned index;
+    unsigned child;
+    intptr_t sum;
+} JoinNode;
+
+static JoinNode joinTree[JOIN_NODES];
+
+static PT_THREAD(joinNode(Task *task))
+{
+    JoinNode *self = (JoinNode *)task;
+
+    PT_BEGIN(&task->pt);
+    if (self->index >= JOIN_NODES - JOIN_LEAVES) {
+        // Folha: cede a vez algumas vezes antes de entregar o próprio índice
+        for (self->child = 0; self->child < self->index % JOIN_FANOUT; self->child++) {
+            PT_YIELD(&task->pt);
+        }
+        PT_TASK_RETURN(task, self->index);
+    }
+    for (self->child = 0; self->child < JOIN_FANOUT; self->child++) {
+        JoinNode *child = &joinTree[self->index * JOIN_FANOUT + 1 + self->child];
+        child->index = self->index * JOIN_FANOUT + 1 + self->child;
+        taskSpawn(task->scheduler, &child->task, joinNode);
+    }
+    for (self->sum = 0, self->child = 0; self->child < JOIN_FANOUT; self->child++) {
+        PT_TASK_JOIN(task, &joinTree[self->index * JOIN_FANOUT + 1 + self->child].task);
+        self->sum += joinTree[self->index * JOIN_FANOUT + 1 + self->child].task.result;
+    }
+    PT_TASK_RETURN(task, self->sum);
+    PT_END(&task->pt);
+}
+
+static char * testTaskJoin(void) {
+    Scheduler scheduler;
+    intptr_t expected = 0;
+
+    for (unsigned i = JOIN_NODES - JOIN_LEAVES; i < JOIN_NODES; i++) {
+        expected += i;
+    }
+    schedulerInit(&scheduler);
+    joinTree[0].index = 0;
+    taskSpawn(&scheduler, &joinTree[0].task, joinNode);
+    schedulerRun(&scheduler);
+
+    verifica("erro: soma entregue pela árvore", joinTree[0].task.result == expected);
+    // Nó interno: uma execução inicial e no máximo uma por filha; folha: uma por PT_YIELD, mais
+    // uma. Com PT_WAIT_THREAD, cada volta reexecutaria a subárvore inteira.
+    verifica("erro: tarefa executada sem estar pronta",
+             scheduler.runs <= (JOIN_NODES - JOIN_LEAVES) * (1 + JOIN_FANOUT) + JOIN_LEAVES * JOIN_FANOUT);
+    verifica("erro: tarefas não terminaram", scheduler.live == 0);
+    schedulerDestroy(&scheduler);
+    return 0;
+}
+
+/* Pares em ping-pong entre workers e uma tarefa acordada por uma thread de fora do executor */
+#define EXEC_PAIRS  200
+#define EXEC_ROUNDS 200
+
+typedef struct {
+    ExecTask task;
+    struct ExecPair *pair;
+    unsigned round;
+} PairTask;
+
+typedef struct ExecPair {
+    PairTask ping, pong;
+    atomic_uint turn;    // 0: vez do ping; 1: vez do pong
+    atomic_uint volleys;
+} ExecPair;
+
+static PT_THREAD(execPing(ExecTask *task))
+{
+    PairTask *self = (PairTask *)task;
+    ExecPair *p = self->pair;
+
+    PT_BEGIN(&task->pt);
+    for (self->round = 0; self->round < EXEC_ROUNDS; self->round++) {
+        PT_WAIT_UNTIL(&task->pt, atomic_load(&p->turn) == 0);
+        atomic_store(&p->turn, 1);
+        execWake(&p->pong.task);
+    }
+    PT_END(&task->pt);
+}
+
+static PT_THREAD(execPong(ExecTask *task))
+{
+    PairTask *self = (PairTask *)task;
+    ExecPair *p = self->pair;
+
+    PT_BEGIN(&task->pt);
+    for (self->round = 0; self->round < EXEC_ROUNDS; self->round++) {
+        PT_WAIT_UNTIL(&task->pt, atomic_load(&p->turn) == 1);
+        atomic_fetch_add(&p->volleys, 1);
+        atomic_store(&p->turn, 0);
+        execWake(&p->ping.task);
+    }
+    PT_END(&task->pt);
+}
+
+typedef struct {
+    ExecTask task;
+    atomic_uint posted;
+    unsigned seen;
+} External;
+
+static PT_THREAD(execExternal(ExecTask *task))
+{
+    External *self = (External *)task;
+
+    PT_BEGIN(&task->pt);
+    while (self->seen < 1000) {
+        PT_WAIT_UNTIL(&task->pt, atomic_load(&self->posted) > self->seen);
+        self->seen = atomic_load(&self->posted);
+    }
+    PT_END(&task->pt);
+}
+
+static void * postExternal(void *arg) {
+    External *external = arg;
+    for (int i = 0; i < 1000; i++) {
+        atomic_fetch_add(&external->posted, 1);
+        execWake(&external->task); // Como uma interrupção
+    }
+    return NULL;
+}
+
+static char * testExecutor(void) {
+    static ExecPair pairs[EXEC_PAIRS];
+    static External external;
+    Executor ex;
+    pthread_t thread;
+
+    verifica("erro: executor sem memória", executorInit(&ex, 4));
+    for (int i = 0; i < EXEC_PAIRS; i++) {
+        pairs[i].ping.pair = pairs[i].pong.pair = &pairs[i];
+        atomic_init(&pairs[i].turn, 0);
+        atomic_init(&pairs[i].volleys, 0);
+        execSpawn(&ex, &pairs[i].ping.task, execPing);
+        execSpawn(&ex, &pairs[i].pong.task, execPong);
+    }
+    atomic_init(&external.posted, 0);
+    external.seen = 0;
+    execSpawn(&ex, &external.task, execExternal);
+    verifica("erro: thread externa não criada", pthread_create(&thread, NULL, postExternal, &external) == 0);
+    executorRun(&ex);
+    pthread_join(thread, NULL);
+
+    for (int i = 0; i < EXEC_PAIRS; i++) {
+        verifica("erro: rodadas de ping-pong perdidas", atomic_load(&pairs[i].volleys) == EXEC_ROUNDS);
+    }
+    verifica("erro: acordar externo perdido", external.seen == 1000);
+    verifica("erro: execuções contadas", ex.runs >= 2 * EXEC_PAIRS + 1);
+    executorDestroy(&ex);
+    return 0;
+}
+
+/* Função que executa todos os testes */
+static char * executa_testes(void) {
+    executa_teste(testRingWrap);
+    executa_teste(testFrameReceiver);
+    executa_teste(testPtSleepInstances);
+    executa_teste(testPtPool);
+    executa_teste(testPtPoolSpawn);
+    executa_teste(testPtMailbox);
+#ifdef PT_PROFILE
+    executa_teste(testPtProfile);
+    executa_teste(testPtProfileLoop);
+#endif
+    executa_teste(testTimerWheel);
+    executa_teste(testSchedulerSemaphore);
+    executa_teste(testSchedulerEarlyWake);
+    executa_teste(testSchedulerSleep);
+    executa_teste(testPtClockSimulated);
+    executa_teste(testArq);
+    executa_teste(testBulkPipe);
+    executa_teste(testSchedulerCrossThread);
+    executa_teste(testTaskJoin);
+    executa_teste(testReactor);
+    executa_teste(testExecutor);
+    return 0;
+}
+
+int main() {
+    char *resultado = executa_testes();
+    if (resultado != 0) {
+        printf("%s\n", resultado);
+    } else {
+        printf("Sucesso!\n");
+    }
+    printf("Testes executados: %d\n", testes_executados);
+
+    return resultado != 0;
+}
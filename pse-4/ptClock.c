@@ -0,0 +1,44 @@
+/**
+ * @file ptClock.c
+ * @brief Implementação do relógio real/virtual descrito em ptClock.h.
+ */
+#include "ptClock.h"
+
+PtClock ptClock;
+
+void ptClockSimulate(uint32_t start) {
+    ptClock.simulated = true;
+    ptClock.now = start;
+    ptClock.hasDeadline = false;
+}
+
+void ptClockReal(void) {
+    ptClock.simulated = false;
+    ptClock.hasDeadline = false;
+}
+
+void ptClockAdvance(uint32_t ms) {
+    if (ptClock.simulated) {
+        ptClock.now += ms;
+    }
+}
+
+void ptClockIdle(uint32_t maxMs) {
+    uint32_t delay = maxMs;
+
+    if (ptClock.hasDeadline) {
+        int32_t untilDeadline = (int32_t)(ptClock.nextDeadline - ptClockMs());
+        if (untilDeadline < 0) {
+            delay = 0;
+        } else if ((uint32_t)untilDeadline < delay) {
+            delay = (uint32_t)untilDeadline;
+        }
+        ptClock.hasDeadline = false;
+    }
+    if (ptClock.simulated) {
+        ptClock.now += delay;
+    } else if (delay > 0) {
+        struct timespec nap = {.tv_sec = delay / 1000, .tv_nsec = (long)(delay % 1000) * 1000000};
+        nanosleep(&nap, NULL);
+    }
+}
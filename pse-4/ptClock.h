@@ -0,0 +1,87 @@
+/**
+ * @file ptClock.h
+ * @brief Relógio das protothreads: monotônico real ou virtual, para simulações reproduzíveis.
+ *
+ * Todos os prazos de protothreads do pse-4 (PT_SLEEP de ptSleep.h, PT_SLEEP_MS e a roda de
+ * temporizadores do escalonador) leem o tempo por ptClockMs. Por padrão é o CLOCK_MONOTONIC em
+ * milissegundos. Com ptClockSimulate, passa a ser um contador que só anda quando o programa
+ * manda: o laço ocioso salta direto para o próximo prazo em vez de dormir, então uma simulação
+ * roda tão rápido quanto a CPU permite e, sem leituras do relógio real, repete exatamente a
+ * mesma sequência de execuções a cada vez (mesmo instante inicial, mesmas entradas).
+ *
+ * Laço de varredura: ptClockIdle no lugar do nanosleep entre voltas. No modo real dorme até o
+ * próximo prazo (no máximo maxMs); no virtual avança o relógio até ele. O próximo prazo é o
+ * menor anotado por ptClockNoteDeadline desde a última ociosidade (ptDeadlineReached anota os
+ * prazos de PT_SLEEP que ainda não venceram). O escalonador (scheduler.c) consulta a própria
+ * roda de temporizadores.
+ *
+ * O relógio virtual é global e deve ser escolhido antes de schedulerInit e dos primeiros
+ * PT_SLEEP; é para simulações em uma thread (o relógio real continua seguro entre threads).
+ *
+ *   ptClockSimulate(0);
+ *   while (live > 0) {
+ *       ... PT_SCHEDULE de cada protothread ...
+ *       ptClockIdle(1000);
+ *   }
+ *   printf("%u ms simulados\n", ptClockMs());
+ */
+#ifndef PT_CLOCK_H
+#define PT_CLOCK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    bool simulated;       // Relógio virtual em uso
+    uint32_t now;         // Instante virtual (ms)
+    bool hasDeadline;     // nextDeadline anotado desde a última ociosidade
+    uint32_t nextDeadline;
+} PtClock;
+
+extern PtClock ptClock;
+
+/** Tempo do CLOCK_MONOTONIC em milissegundos. */
+static inline uint32_t ptClockMonotonicMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000u + ts.tv_nsec / 1000000);
+}
+
+/** Tempo atual (ms) do relógio em uso. */
+static inline uint32_t ptClockMs(void) {
+    return ptClock.simulated ? ptClock.now : ptClockMonotonicMs();
+}
+
+/** Registra um prazo ainda não vencido, para ptClockIdle saber até quando esperar. */
+static inline void ptClockNoteDeadline(uint32_t deadline) {
+    if (!ptClock.hasDeadline || (int32_t)(deadline - ptClock.nextDeadline) < 0) {
+        ptClock.nextDeadline = deadline;
+        ptClock.hasDeadline = true;
+    }
+}
+
+/** Passa a usar o relógio virtual, começando em start (ms). */
+void ptClockSimulate(uint32_t start);
+
+/** Volta ao relógio monotônico real. */
+void ptClockReal(void);
+
+/** Avança o relógio virtual em ms (sem efeito no relógio real). */
+void ptClockAdvance(uint32_t ms);
+
+/**
+ * Espera do laço de varredura sem protothreads prontas: até o próximo prazo anotado, no máximo
+ * maxMs. Dorme com o relógio real; avança o relógio virtual.
+ */
+void ptClockIdle(uint32_t maxMs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PT_CLOCK_H
@@ -0,0 +1,259 @@
+/**
+ * @file ptCoro.hpp
+ * @brief Protothreads como corrotinas do C++20, com as operações de pt.h.
+ *
+ * Alternativa opcional às continuações locais de pt-1.4 para código em C++. Com lc-switch.h as
+ * variáveis locais não sobrevivem a um PT_YIELD/PT_WAIT_UNTIL e não se pode usar switch dentro
+ * da protothread, o que empurra o estado para variáveis static (uma instância só) ou para
+ * estruturas de contexto escritas à mão. Aqui a protothread é uma corrotina: o compilador guarda
+ * as variáveis locais que atravessam uma espera no quadro da corrotina, um por instância, e o
+ * corpo pode usar switch, laços e variáveis locais normalmente.
+ *
+ * Os quadros são alocados de um FramePool (por thread): listas livres por classe de tamanho
+ * (múltiplos de 16 bytes, o alinhamento do new), retiradas de blocos de 64 KiB, sem malloc por
+ * tarefa depois do aquecimento. Um quadro deve ser destruído na thread que o criou.
+ *
+ * Thread::schedule() tem o contrato de uma chamada de protothread: retorna PT_WAITING,
+ * PT_YIELDED ou PT_ENDED, então PT_SCHEDULE(t.schedule()) funciona como com pt.h. Uma espera
+ * guarda a sua condição na corrotina, e schedule() a avalia antes de retomar: uma reavaliação
+ * sem progresso custa uma chamada de função, sem reentrar no corpo. Diferente de pt.h, uma
+ * corrotina que terminou não recomeça; schedule() continua retornando PT_ENDED.
+ *
+ * Portar uma protothread é mecânico: o tipo de retorno passa a ser ptcoro::Thread, PT_BEGIN e
+ * PT_END saem, as macros perdem o argumento pt (PT_WAIT_UNTIL(pt, c) vira PT_CO_WAIT_UNTIL(c))
+ * e as variáveis static podem voltar a ser locais. Os semáforos continuam sendo struct pt_sem
+ * (pt-sem.h).
+ *
+ *   ptcoro::Thread consumer(struct pt_sem *items) {
+ *       for (int n = 0;; n++) {
+ *           PT_CO_SEM_WAIT(items);
+ *           ...
+ *       }
+ *   }
+ *
+ *   ptcoro::Thread t = consumer(&items);
+ *   while (PT_SCHEDULE(t.schedule())) { ... }
+ */
+#ifndef PT_CORO_HPP
+#define PT_CORO_HPP
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <utility>
+
+#include "pt-1.4/pt.h"
+#include "pt-1.4/pt-sem.h"
+
+namespace ptcoro {
+
+/** Alocador dos quadros das corrotinas: listas livres por classe de tamanho. */
+class FramePool {
+public:
+    static constexpr std::size_t GRAIN = 16;          // Granularidade e alinhamento das classes
+    static constexpr std::size_t CLASSES = 64;        // Quadros de até 1 KiB; maiores vão ao new
+    static constexpr std::size_t CHUNK = 64 * 1024;   // Bloco de onde os quadros são retirados
+
+    FramePool() = default;
+    FramePool(const FramePool &) = delete;
+    FramePool &operator=(const FramePool &) = delete;
+
+    ~FramePool() {
+        while (chunks_ != nullptr) {
+            Node *next = chunks_->next;
+            std::free(chunks_);
+            chunks_ = next;
+        }
+    }
+
+    void *allocate(std::size_t size) {
+        std::size_t cls = (size + GRAIN - 1) / GRAIN;
+        if (cls > CLASSES) {
+            return ::operator new(size);
+        }
+        inUse_ += cls * GRAIN;
+        Node *node = free_[cls - 1];
+        if (node != nullptr) {
+            free_[cls - 1] = node->next;
+            return node;
+        }
+        return carve(cls * GRAIN);
+    }
+
+    void release(void *frame, std::size_t size) noexcept {
+        std::size_t cls = (size + GRAIN - 1) / GRAIN;
+        if (cls > CLASSES) {
+            ::operator delete(frame);
+            return;
+        }
+        inUse_ -= cls * GRAIN;
+        Node *node = static_cast<Node *>(frame);
+        node->next = free_[cls - 1];
+        free_[cls - 1] = node;
+    }
+
+    /** Bytes em quadros vivos (arredondados para a classe). */
+    std::size_t bytesInUse() const { return inUse_; }
+
+    /** Bytes obtidos do sistema em blocos. */
+    std::size_t bytesReserved() const { return reserved_; }
+
+private:
+    struct Node {
+        Node *next;
+    };
+
+    void *carve(std::size_t bytes) {
+        if (cursor_ == nullptr || cursor_ + bytes > end_) {
+            // O início do bloco encadeia os blocos; os quadros começam GRAIN bytes depois
+            Node *chunk = static_cast<Node *>(std::malloc(CHUNK));
+            if (chunk == nullptr) {
+                throw std::bad_alloc();
+            }
+            chunk->next = chunks_;
+            chunks_ = chunk;
+            reserved_ += CHUNK;
+            cursor_ = reinterpret_cast<char *>(chunk) + GRAIN;
+            end_ = reinterpret_cast<char *>(chunk) + CHUNK;
+        }
+        void *frame = cursor_;
+        cursor_ += bytes;
+        return frame;
+    }
+
+    Node *free_[CLASSES] = {};
+    Node *chunks_ = nullptr;
+    char *cursor_ = nullptr;
+    char *end_ = nullptr;
+    std::size_t inUse_ = 0;
+    std::size_t reserved_ = 0;
+};
+
+/** Pool de quadros da thread atual. */
+inline FramePool &framePool() {
+    thread_local FramePool pool;
+    return pool;
+}
+
+/** Uma protothread: dona do quadro da corrotina. */
+class Thread {
+public:
+    struct promise_type {
+        bool (*ready)(void *awaiter) = nullptr; // Condição da espera em andamento (nullptr: nenhuma)
+        void *awaiter = nullptr;
+
+        Thread get_return_object() {
+            return Thread(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        // Como PT_INIT: o corpo só começa na primeira chamada a schedule()
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::abort(); }
+
+        static void *operator new(std::size_t size) { return framePool().allocate(size); }
+        static void operator delete(void *frame, std::size_t size) noexcept {
+            framePool().release(frame, size);
+        }
+    };
+
+    Thread() = default;
+    Thread(Thread &&other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+    Thread &operator=(Thread &&other) noexcept {
+        if (this != &other) {
+            destroy();
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+    ~Thread() { destroy(); }
+
+    /** Executa a protothread até a próxima espera. Retorna PT_WAITING, PT_YIELDED ou PT_ENDED. */
+    char schedule() {
+        if (!handle_ || handle_.done()) {
+            return PT_ENDED;
+        }
+        promise_type &promise = handle_.promise();
+        if (promise.ready != nullptr) {
+            if (!promise.ready(promise.awaiter)) {
+                return PT_WAITING;
+            }
+            promise.ready = nullptr;
+        }
+        handle_.resume();
+        if (handle_.done()) {
+            return PT_ENDED;
+        }
+        return promise.ready != nullptr ? PT_WAITING : PT_YIELDED;
+    }
+
+    bool done() const { return !handle_ || handle_.done(); }
+
+private:
+    explicit Thread(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+    void destroy() {
+        if (handle_) {
+            handle_.destroy();
+            handle_ = nullptr;
+        }
+    }
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+/** Espera até condition() ser verdadeira (PT_WAIT_UNTIL). */
+template <typename Condition>
+struct WaitUntil {
+    Condition condition;
+
+    bool await_ready() { return condition(); }
+    void await_suspend(std::coroutine_handle<Thread::promise_type> handle) noexcept {
+        handle.promise().ready = &check;
+        handle.promise().awaiter = this;
+    }
+    void await_resume() const noexcept {}
+
+    static bool check(void *self) { return static_cast<WaitUntil *>(self)->condition(); }
+};
+
+template <typename Condition>
+WaitUntil<Condition> waitUntil(Condition condition) {
+    return {std::move(condition)};
+}
+
+/** Cede a vez uma execução (PT_YIELD). */
+struct Yield {
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<Thread::promise_type>) const noexcept {}
+    void await_resume() const noexcept {}
+};
+
+/** Espera o semáforo ser positivo e o decrementa (PT_SEM_WAIT). */
+struct SemWait {
+    struct pt_sem *sem;
+
+    bool await_ready() const noexcept { return sem->count > 0; }
+    void await_suspend(std::coroutine_handle<Thread::promise_type> handle) noexcept {
+        handle.promise().ready = &check;
+        handle.promise().awaiter = this;
+    }
+    void await_resume() noexcept { --sem->count; }
+
+    static bool check(void *self) { return static_cast<SemWait *>(self)->sem->count > 0; }
+};
+
+} // namespace ptcoro
+
+#define PT_CO_WAIT_UNTIL(condition) \
+    co_await ::ptcoro::waitUntil([&]() -> bool { return (condition); })
+#define PT_CO_WAIT_WHILE(condition) PT_CO_WAIT_UNTIL(!(condition))
+/** Espera a protothread filha (ptcoro::Thread) terminar, executando-a a cada volta. */
+#define PT_CO_WAIT_THREAD(thread)   PT_CO_WAIT_WHILE(PT_SCHEDULE((thread).schedule()))
+#define PT_CO_YIELD()               co_await ::ptcoro::Yield{}
+#define PT_CO_SEM_WAIT(s)           co_await ::ptcoro::SemWait{(s)}
+#define PT_CO_SEM_SIGNAL(s)         (++(s)->count)
+#define PT_CO_EXIT()                co_return
+
+#endif // PT_CORO_HPP
@@ -0,0 +1,199 @@
+/**
+ * @file ptCoroBench.cpp
+ * @brief Ping-pong de protothreads: corrotinas do C++20 (ptCoro.hpp) contra lc-switch.
+ *
+ * O cenário "sem" de ptScaleBench.c nos dois backends, no mesmo binário: pares de protothreads
+ * trocam a vez por dois semáforos de pt-sem.h (ping espera toPing e sinaliza toPong; pong o
+ * inverso), e o laço de varredura executa todas as protothreads a cada volta. Com lc-switch,
+ * cada chamada reentra no corpo pela continuação local; com as corrotinas, schedule() avalia a
+ * condição guardada e só retoma o quadro quando o semáforo está positivo.
+ *
+ * Relata, por número de protothreads: execuções/s, repasses/s, ns por execução e a memória por
+ * protothread. Para lc-switch, struct pt mais a parte do par (contadores de rodada e
+ * semáforos); para as corrotinas, o ptcoro::Thread, o quadro (classe do FramePool, que inclui o
+ * contador de rodada local) e a parte do par.
+ *
+ *   ptCoroBench [protothreads...]   (padrão 100 1000 10000)
+ */
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <vector>
+
+#include "ptCoro.hpp"
+
+#define VOLLEYS 2000000 // Rodadas de ping-pong somadas de todos os pares (por execução)
+
+static uint64_t handoffs;
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void report(const char *backend, int threads, uint64_t calls, double elapsed, size_t bytes) {
+    printf("%-10s %7d %12.2f %12.2f %9.1f %9zu\n", backend, threads, calls / elapsed / 1e6,
+           handoffs / elapsed / 1e6, elapsed * 1e9 / calls, bytes);
+}
+
+/* lc-switch: o contador de rodada fica no par, fora da protothread */
+typedef struct {
+    struct pt ping, pong;
+    struct pt_sem toPing, toPong;
+    unsigned pingRound, pongRound, rounds;
+    bool pingDone, pongDone;
+} Pair;
+
+static PT_THREAD(ping(Pair *p))
+{
+    struct pt *pt = &p->ping;
+
+    PT_BEGIN(pt);
+    for (p->pingRound = 0; p->pingRound < p->rounds; p->pingRound++) {
+        PT_SEM_WAIT(pt, &p->toPing);
+        PT_SEM_SIGNAL(pt, &p->toPong);
+    }
+    PT_END(pt);
+}
+
+static PT_THREAD(pong(Pair *p))
+{
+    struct pt *pt = &p->pong;
+
+    PT_BEGIN(pt);
+    for (p->pongRound = 0; p->pongRound < p->rounds; p->pongRound++) {
+        PT_SEM_WAIT(pt, &p->toPong);
+        handoffs++;
+        PT_SEM_SIGNAL(pt, &p->toPing);
+    }
+    PT_END(pt);
+}
+
+static void runSwitch(int pairs, unsigned rounds) {
+    std::vector<Pair> all(pairs);
+    uint64_t calls = 0;
+    int live = 2 * pairs;
+
+    for (Pair &p : all) {
+        PT_INIT(&p.ping);
+        PT_INIT(&p.pong);
+        PT_SEM_INIT(&p.toPing, 1);
+        PT_SEM_INIT(&p.toPong, 0);
+        p.rounds = rounds;
+        p.pingDone = p.pongDone = false;
+    }
+
+    handoffs = 0;
+    double start = now();
+    while (live > 0) {
+        for (Pair &p : all) {
+            // Uma protothread que terminou recomeçaria se fosse chamada de novo
+            if (!p.pingDone) {
+                calls++;
+                if (!PT_SCHEDULE(ping(&p))) {
+                    p.pingDone = true;
+                    live--;
+                }
+            }
+            if (!p.pongDone) {
+                calls++;
+                if (!PT_SCHEDULE(pong(&p))) {
+                    p.pongDone = true;
+                    live--;
+                }
+            }
+        }
+    }
+    report("lc-switch", 2 * pairs, calls, now() - start, sizeof(struct pt) + (sizeof(Pair) - 2 * sizeof(struct pt)) / 2);
+}
+
+/* Corrotinas: o contador de rodada é uma variável local, guardada no quadro */
+typedef struct {
+    ptcoro::Thread ping, pong;
+    struct pt_sem toPing, toPong;
+    bool pingDone, pongDone;
+} CoPair;
+
+static ptcoro::Thread coPing(CoPair *p, unsigned rounds) {
+    for (unsigned round = 0; round < rounds; round++) {
+        PT_CO_SEM_WAIT(&p->toPing);
+        PT_CO_SEM_SIGNAL(&p->toPong);
+    }
+}
+
+static ptcoro::Thread coPong(CoPair *p, unsigned rounds) {
+    for (unsigned round = 0; round < rounds; round++) {
+        PT_CO_SEM_WAIT(&p->toPong);
+        handoffs++;
+        PT_CO_SEM_SIGNAL(&p->toPing);
+    }
+}
+
+static void runCoro(int pairs, unsigned rounds) {
+    std::vector<CoPair> all(pairs);
+    uint64_t calls = 0;
+    int live = 2 * pairs;
+    size_t frames = ptcoro::framePool().bytesInUse();
+
+    for (CoPair &p : all) {
+        PT_SEM_INIT(&p.toPing, 1);
+        PT_SEM_INIT(&p.toPong, 0);
+        p.ping = coPing(&p, rounds);
+        p.pong = coPong(&p, rounds);
+        p.pingDone = p.pongDone = false;
+    }
+    frames = (ptcoro::framePool().bytesInUse() - frames) / (2 * pairs);
+
+    handoffs = 0;
+    double start = now();
+    while (live > 0) {
+        for (CoPair &p : all) {
+            if (!p.pingDone) {
+                calls++;
+                if (!PT_SCHEDULE(p.ping.schedule())) {
+                    p.pingDone = true;
+                    live--;
+                }
+            }
+            if (!p.pongDone) {
+                calls++;
+                if (!PT_SCHEDULE(p.pong.schedule())) {
+                    p.pongDone = true;
+                    live--;
+                }
+            }
+        }
+    }
+    report("corrotina", 2 * pairs, calls, now() - start, sizeof(ptcoro::Thread) + frames +
+           (sizeof(CoPair) - 2 * sizeof(ptcoro::Thread)) / 2);
+}
+
+int main(int argc, char *argv[]) {
+    static const int defaults[] = {100, 1000, 10000};
+    std::vector<int> counts(defaults, defaults + 3);
+
+    if (argc > 1) {
+        counts.clear();
+        for (int i = 1; i < argc; i++) {
+            counts.push_back(atoi(argv[i]));
+        }
+    }
+    // Larguras dos títulos acentuados somam os bytes extras do UTF-8
+    printf("%-10s %7s %12s %12s %10s %9s\n", "backend", "threads", "Mexecs/s", "Mrepasses/s",
+           "ns/execução", "bytes/pt");
+    for (int threads : counts) {
+        int pairs = threads >= 2 ? threads / 2 : 1;
+        unsigned rounds = VOLLEYS / (unsigned)pairs;
+
+        if (rounds == 0) {
+            rounds = 1;
+        }
+        runSwitch(pairs, rounds);
+        runCoro(pairs, rounds);
+    }
+    printf("quadro das corrotinas: classes de %zu bytes; %zu KiB reservados no pool\n",
+           ptcoro::FramePool::GRAIN, ptcoro::framePool().bytesReserved() / 1024);
+    return 0;
+}
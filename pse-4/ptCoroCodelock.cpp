@@ -0,0 +1,223 @@
+/**
+ * @file ptCoroCodelock.cpp
+ * @brief example-codelock.c do pt-1.4 portado para as corrotinas de ptCoro.hpp.
+ *
+ * A fechadura com código espera as teclas 1-4-2-3, com no máximo um segundo entre duas teclas,
+ * e só abre se nenhuma tecla for pressionada no meio segundo seguinte. input_thread simula as
+ * teclas. O porte é mecânico: PT_THREAD vira ptcoro::Thread, PT_BEGIN/PT_END saem,
+ * PT_WAIT_UNTIL(pt, c) vira PT_CO_WAIT_UNTIL(c) e PT_EXIT(pt) vira PT_CO_EXIT(). O contador de
+ * teclas e os temporizadores deixam de ser static: ficam no quadro de cada corrotina.
+ *
+ * Os temporizadores usam o relógio de ptClock.h no lugar de gettimeofday, e o laço principal
+ * chama ptClockIdle no lugar de usleep. Com -s, o relógio é virtual: os cerca de 10 s do roteiro
+ * de teclas rodam instantaneamente e sempre da mesma forma.
+ *
+ *   ptCoroCodelock [-s]
+ */
+#include <cstdio>
+#include <cstring>
+
+#include "ptClock.h"
+#include "ptCoro.hpp"
+
+struct timer { int start, interval; };
+static int  timer_expired(struct timer *t);
+static void timer_set(struct timer *t, int usecs);
+
+static const char code[4] = {'1', '4', '2', '3'};
+
+static char key, key_pressed_flag;
+
+static void
+press_key(char k)
+{
+  printf("--- Key '%c' pressed\n", k);
+  key = k;
+  key_pressed_flag = 1;
+}
+
+static int
+key_pressed(void)
+{
+  if(key_pressed_flag != 0) {
+    key_pressed_flag = 0;
+    return 1;
+  }
+  return 0;
+}
+
+static ptcoro::Thread
+codelock_thread(void)
+{
+  /* Locais comuns: sobrevivem às esperas no quadro da corrotina */
+  struct timer codelock_timer;
+  unsigned keys;
+
+  while(1) {
+
+    for(keys = 0; keys < sizeof(code); ++keys) {
+
+      if(keys == 0) {
+	PT_CO_WAIT_UNTIL(key_pressed());
+      } else {
+	timer_set(&codelock_timer, 1000);
+	PT_CO_WAIT_UNTIL(key_pressed() || timer_expired(&codelock_timer));
+
+	if(timer_expired(&codelock_timer)) {
+	  printf("Code lock timer expired.\n");
+	  break;
+	}
+      }
+
+      if(key != code[keys]) {
+	printf("Incorrect key '%c' found\n", key);
+	break;
+      } else {
+	printf("Correct key '%c' found\n", key);
+      }
+    }
+
+    if(keys == sizeof(code)) {
+      printf("Correct code entered, waiting for 500 ms before unlocking.\n");
+
+      timer_set(&codelock_timer, 500);
+      PT_CO_WAIT_UNTIL(key_pressed() || timer_expired(&codelock_timer));
+
+      if(!timer_expired(&codelock_timer)) {
+	printf("Key pressed during final wait, code lock locked again.\n");
+      } else {
+	printf("Code lock unlocked.\n");
+	PT_CO_EXIT();
+      }
+    }
+  }
+}
+
+static ptcoro::Thread
+input_thread(void)
+{
+  struct timer input_timer;
+
+  printf("Waiting 1 second before entering first key.\n");
+
+  timer_set(&input_timer, 1000);
+  PT_CO_WAIT_UNTIL(timer_expired(&input_timer));
+
+  press_key('1');
+
+  timer_set(&input_timer, 100);
+  PT_CO_WAIT_UNTIL(timer_expired(&input_timer));
+
+  press_key('2');
+
+  timer_set(&input_timer, 100);
+  PT_CO_WAIT_UNTIL(timer_expired(&input_timer));
+
+  press_key('3');
+
+  timer_set(&input_timer, 2000);
+  PT_CO_WAIT_UNTIL(timer_expired(&input_timer));
+
+  press_key('1');
+
+  timer_set(&input_timer, 200);
+  PT_CO_WAIT_UNTIL(timer_expired(&input_timer));
+
+  press_key('4');
+
+  timer_set(&input_timer, 200);
+  PT_CO_WAIT_UNTIL(timer_expired(&input_timer));
+
+  press_key('2');
+
+  timer_set(&input_timer, 2000);
+  PT_CO_WAIT_UNTIL(timer_expired(&input_timer));
+
+  press_key('3');
+
+  timer_set(&input_timer, 200);
+  PT_CO_WAIT_UNTIL(timer_expired(&input_timer));
+
+  press_key('1');
+
+  timer_set(&input_timer, 200);
+  PT_CO_WAIT_UNTIL(timer_expired(&input_timer));
+
+  press_key('4');
+
+  timer_set(&input_timer, 200);
+  PT_CO_WAIT_UNTIL(timer_expired(&input_timer));
+
+  press_key('2');
+
+  timer_set(&input_timer, 100);
+  PT_CO_WAIT_UNTIL(timer_expired(&input_timer));
+
+  press_key('3');
+
+  timer_set(&input_timer, 100);
+  PT_CO_WAIT_UNTIL(timer_expired(&input_timer));
+
+  press_key('4');
+
+  timer_set(&input_timer, 1500);
+  PT_CO_WAIT_UNTIL(timer_expired(&input_timer));
+
+  press_key('1');
+
+  timer_set(&input_timer, 300);
+  PT_CO_WAIT_UNTIL(timer_expired(&input_timer));
+
+  press_key('4');
+
+  timer_set(&input_timer, 400);
+  PT_CO_WAIT_UNTIL(timer_expired(&input_timer));
+
+  press_key('2');
+
+  timer_set(&input_timer, 500);
+  PT_CO_WAIT_UNTIL(timer_expired(&input_timer));
+
+  press_key('3');
+
+  timer_set(&input_timer, 2000);
+  PT_CO_WAIT_UNTIL(timer_expired(&input_timer));
+}
+
+int
+main(int argc, char *argv[])
+{
+  bool simulate = argc > 1 && strcmp(argv[1], "-s") == 0;
+
+  if(simulate) {
+    ptClockSimulate(0);
+  }
+
+  ptcoro::Thread codelock = codelock_thread();
+  ptcoro::Thread input = input_thread();
+
+  while(PT_SCHEDULE(codelock.schedule())) {
+    input.schedule();
+    ptClockIdle(1);
+  }
+
+  if(simulate) {
+    printf("Simulated time: %u ms\n", ptClockMs());
+  }
+  return 0;
+}
+
+static int clock_time(void)
+{ return (int)ptClockMs(); }
+
+static int timer_expired(struct timer *t)
+{
+  if((int)(clock_time() - t->start) >= (int)t->interval) {
+    return 1;
+  }
+  ptClockNoteDeadline((uint32_t)(t->start + t->interval));
+  return 0;
+}
+
+static void timer_set(struct timer *t, int interval)
+{ t->interval = interval; t->start = clock_time(); }
@@ -0,0 +1,147 @@
+/**
+ * @file ptCoroTests.cpp
+ * @brief Testes das protothreads como corrotinas do C++20 (ptCoro.hpp).
+ */
+#include <cstdio>
+#include <vector>
+
+#include "ptCoro.hpp"
+
+/* macros de testes - baseado em minUnit: www.jera.com/techinfo/jtns/jtn002.html */
+#define verifica(mensagem, teste) do { if (!(teste)) return mensagem; } while (0)
+#define executa_teste(teste) do { const char *mensagem = teste(); testes_executados++; \
+                                if (mensagem) return mensagem; } while (0)
+
+int testes_executados = 0;
+
+/* Cada instância conta com variáveis locais e um switch, que lc-switch não permite */
+static ptcoro::Thread counter(unsigned id, unsigned *total) {
+    unsigned sum = 0;
+
+    for (unsigned step = 0; step < 4; step++) {
+        switch ((id + step) % 3) {
+        case 0:
+            sum += 1;
+            break;
+        case 1:
+            PT_CO_YIELD();
+            sum += 10;
+            break;
+        default:
+            sum += 100;
+            break;
+        }
+        PT_CO_YIELD();
+    }
+    *total += sum;
+}
+
+static ptcoro::Thread producer(struct pt_sem *items, struct pt_sem *room, int *slot, int count) {
+    for (int i = 1; i <= count; i++) {
+        PT_CO_SEM_WAIT(room);
+        *slot = i;
+        PT_CO_SEM_SIGNAL(items);
+    }
+}
+
+static ptcoro::Thread consumer(struct pt_sem *items, struct pt_sem *room, int *slot, int count,
+                               int *sum) {
+    // A filha vive no quadro da mãe, que a executa enquanto espera os itens
+    ptcoro::Thread child = producer(items, room, slot, count);
+    for (int i = 0; i < count; i++) {
+        PT_CO_WAIT_UNTIL(!PT_SCHEDULE(child.schedule()) || items->count > 0);
+        PT_CO_SEM_WAIT(items);
+        *sum += *slot;
+        PT_CO_SEM_SIGNAL(room);
+    }
+    PT_CO_WAIT_THREAD(child);
+}
+
+/* Soma que counter(id) acumula */
+static unsigned counterSum(unsigned id) {
+    unsigned sum = 0;
+
+    for (unsigned step = 0; step < 4; step++) {
+        sum += (id + step) % 3 == 0 ? 1 : (id + step) % 3 == 1 ? 10 : 100;
+    }
+    return sum;
+}
+
+/* Variáveis locais e switch sobrevivem às esperas; a corrotina terminada não recomeça */
+static const char * testCoroLocalState(void) {
+    std::vector<ptcoro::Thread> threads;
+    unsigned total = 0, expected = 0;
+    unsigned passes = 0;
+    bool running = true;
+
+    for (unsigned id = 0; id < 100; id++) {
+        threads.push_back(counter(id, &total));
+        expected += counterSum(id);
+    }
+    while (running) {
+        running = false;
+        for (ptcoro::Thread &t : threads) {
+            running |= PT_SCHEDULE(t.schedule());
+        }
+        passes++;
+    }
+    verifica("erro: estado local perdido entre esperas", total == expected);
+    verifica("erro: número de voltas", passes >= 5 && passes <= 9);
+    verifica("erro: corrotina terminada recomeçou", threads[0].schedule() == PT_ENDED);
+    return 0;
+}
+
+/* Quadros vêm do pool e, liberados, voltam às listas livres e são reutilizados sem novos blocos */
+static const char * testCoroFramePool(void) {
+    ptcoro::FramePool &pool = ptcoro::framePool();
+    std::vector<ptcoro::Thread> threads;
+    unsigned total = 0;
+
+    for (unsigned id = 0; id < 100; id++) {
+        threads.push_back(counter(id, &total));
+    }
+    size_t reserved = pool.bytesReserved();
+    verifica("erro: quadros fora do pool", pool.bytesInUse() >= 100 * sizeof(void *));
+    threads.clear();
+    verifica("erro: quadros não devolvidos", pool.bytesInUse() == 0);
+    for (unsigned id = 0; id < 100; id++) {
+        threads.push_back(counter(id, &total));
+    }
+    verifica("erro: pool não reutilizou os quadros", pool.bytesReserved() == reserved);
+    return 0;
+}
+
+/* Produtor e consumidor com pt_sem, o produtor como filha no quadro do consumidor */
+static const char * testCoroSemaphore(void) {
+    struct pt_sem items, room;
+    int slot = 0, sum = 0;
+    unsigned passes;
+
+    PT_SEM_INIT(&items, 0);
+    PT_SEM_INIT(&room, 1);
+    ptcoro::Thread pipeline = consumer(&items, &room, &slot, 50, &sum);
+    for (passes = 0; PT_SCHEDULE(pipeline.schedule()); passes++) {
+        verifica("erro: pipeline não termina", passes < 1000);
+    }
+    verifica("erro: itens perdidos no semáforo", sum == 50 * 51 / 2);
+    return 0;
+}
+
+static const char * executa_testes(void) {
+    executa_teste(testCoroLocalState);
+    executa_teste(testCoroFramePool);
+    executa_teste(testCoroSemaphore);
+    return 0;
+}
+
+int main(void) {
+    const char *resultado = executa_testes();
+    if (resultado != 0) {
+        printf("%s\n", resultado);
+    } else {
+        printf("Sucesso!\n");
+    }
+    printf("Testes executados: %d\n", testes_executados);
+
+    return resultado != 0;
+}
@@ -0,0 +1,81 @@
+/**
+ * @file ptMailbox.h
+ * @brief Caixa de mensagens tipada e limitada para protothreads.
+ *
+ * Substitui o par semáforo + vetor global de example-buffer.c, em que add_to_buffer e
+ * get_from_buffer dividem o mesmo índice e só funcionam em alternância estrita. Aqui a fila
+ * guarda os próprios itens com índices independentes de escrita (head) e leitura (tail), que
+ * crescem livremente; a ocupação é head - tail, então não há contador separado nem um sinal de
+ * semáforo por item. PT_MBOX_RECV_BATCH retira de uma vez todos os itens disponíveis (até um
+ * limite), o que reduz as execuções do consumidor quando o produtor envia em rajadas.
+ *
+ * Como pt-sem.h, vale para protothreads da mesma thread (sem travas) e as esperas são
+ * PT_WAIT_UNTIL comuns. Os macros aceitam qualquer tipo de item:
+ *
+ *   PT_MAILBOX(SampleBox, int16_t, 32);
+ *   static SampleBox box;
+ *
+ *   PT_MBOX_INIT(&box);
+ *   PT_MBOX_SEND(pt, &box, sample);                  // no produtor
+ *   PT_MBOX_RECV_BATCH(pt, &box, samples, 16, n);    // no consumidor
+ */
+#ifndef PT_MAILBOX_H
+#define PT_MAILBOX_H
+
+#include "pt-1.4/pt.h"
+
+/**
+ * Declara o tipo Name: caixa de até capacity itens de ItemType. capacity deve ser potência de 2:
+ * head e tail dão a volta em 2^32, e só com ela a posição i % capacity continua contínua.
+ */
+#define PT_MAILBOX(Name, ItemType, capacity)                   \
+    typedef struct {                                           \
+        ItemType items[capacity];                              \
+        unsigned head; /* Itens já escritos */                 \
+        unsigned tail; /* Itens já lidos */                    \
+    } Name;                                                    \
+    _Static_assert((capacity) > 0 && ((capacity) & ((capacity) - 1)) == 0, \
+                   "PT_MAILBOX: capacidade de " #Name " deve ser potência de 2")
+
+#define PT_MBOX_INIT(mbox) ((mbox)->head = (mbox)->tail = 0)
+
+#define PT_MBOX_CAPACITY(mbox) ((unsigned)(sizeof((mbox)->items) / sizeof((mbox)->items[0])))
+#define PT_MBOX_COUNT(mbox)    ((mbox)->head - (mbox)->tail)
+#define PT_MBOX_EMPTY(mbox)    (PT_MBOX_COUNT(mbox) == 0)
+#define PT_MBOX_FULL(mbox)     (PT_MBOX_COUNT(mbox) == PT_MBOX_CAPACITY(mbox))
+
+// Posição do item de índice livre i (a capacidade constante vira máscara)
+#define PT_MBOX_SLOT(mbox, i)  ((mbox)->items[(i) % PT_MBOX_CAPACITY(mbox)])
+
+/** Bloqueia a protothread até haver espaço e insere item. */
+#define PT_MBOX_SEND(pt, mbox, item)                           \
+    do {                                                       \
+        PT_WAIT_UNTIL(pt, !PT_MBOX_FULL(mbox));                \
+        PT_MBOX_SLOT(mbox, (mbox)->head) = (item);             \
+        (mbox)->head++;                                        \
+    } while (0)
+
+/** Bloqueia a protothread até haver um item e o copia em dest (lvalue). */
+#define PT_MBOX_RECV(pt, mbox, dest)                           \
+    do {                                                       \
+        PT_WAIT_UNTIL(pt, !PT_MBOX_EMPTY(mbox));               \
+        (dest) = PT_MBOX_SLOT(mbox, (mbox)->tail);             \
+        (mbox)->tail++;                                        \
+    } while (0)
+
+/**
+ * Bloqueia a protothread até haver itens e copia em dest (vetor) todos os disponíveis, até max.
+ * count (lvalue) recebe a quantidade copiada.
+ */
+#define PT_MBOX_RECV_BATCH(pt, mbox, dest, max, count)                  \
+    do {                                                                \
+        PT_WAIT_UNTIL(pt, !PT_MBOX_EMPTY(mbox));                        \
+        (count) = PT_MBOX_COUNT(mbox) < (unsigned)(max) ?               \
+                  PT_MBOX_COUNT(mbox) : (unsigned)(max);                \
+        for (unsigned mboxIndex_ = 0; mboxIndex_ < (count); mboxIndex_++) { \
+            (dest)[mboxIndex_] = PT_MBOX_SLOT(mbox, (mbox)->tail + mboxIndex_); \
+        }                                                               \
+        (mbox)->tail += (count);                                        \
+    } while (0)
+
+#endif // PT_MAILBOX_H
@@ -0,0 +1,65 @@
+/**
+ * @file ptPool.c
+ * @brief Implementação do pool de instâncias de protothreads descrito em ptPool.h.
+ */
+#include <string.h>
+
+#include "ptPool.h"
+
+void ptPoolInit(PtPool *pool, void *storage, size_t elementSize, unsigned capacity, uint64_t *used) {
+    pool->storage = storage;
+    pool->elementSize = elementSize;
+    pool->capacity = capacity;
+    pool->count = 0;
+    pool->used = used;
+    memset(used, 0, PT_POOL_WORDS(capacity) * sizeof(uint64_t));
+}
+
+void * ptPoolAlloc(PtPool *pool) {
+    for (unsigned word = 0; word < PT_POOL_WORDS(pool->capacity); word++) {
+        uint64_t free = ~pool->used[word];
+        if (free == 0) {
+            continue;
+        }
+        unsigned index = word * 64 + (unsigned)__builtin_ctzll(free);
+        if (index >= pool->capacity) {
+            break;
+        }
+        pool->used[word] |= 1ull << (index % 64);
+        pool->count++;
+
+        uint8_t *instance = pool->storage + (size_t)index * pool->elementSize;
+        memset(instance, 0, pool->elementSize);
+        PT_INIT((struct pt *)instance);
+        return instance;
+    }
+    return NULL;
+}
+
+void ptPoolFree(PtPool *pool, void *instance) {
+    unsigned index = ptPoolIndex(pool, instance);
+    uint64_t bit = 1ull << (index % 64);
+
+    if (pool->used[index / 64] & bit) {
+        pool->used[index / 64] &= ~bit;
+        pool->count--;
+    }
+}
+
+unsigned ptPoolRun(PtPool *pool, PtPoolFunction function) {
+    for (unsigned word = 0; word < PT_POOL_WORDS(pool->capacity); word++) {
+        uint64_t bits = pool->used[word];
+        while (bits != 0) {
+            unsigned bit = (unsigned)__builtin_ctzll(bits);
+            size_t index = (size_t)word * 64 + bit;
+            struct pt *pt = (struct pt *)(pool->storage + index * pool->elementSize);
+            if (function(pt) >= PT_EXITED) {
+                ptPoolFree(pool, pt);
+            }
+            // Relê a palavra depois de cada execução: alocações e liberações feitas pela
+            // instância já valem para as posições seguintes desta passada
+            bits = bit == 63 ? 0 : pool->used[word] & (~0ull << (bit + 1));
+        }
+    }
+    return pool->count;
+}
@@ -0,0 +1,97 @@
+/**
+ * @file ptPool.h
+ * @brief Contexto por instância para protothreads e pool de instâncias.
+ *
+ * Uma protothread perde as variáveis locais a cada espera (a continuação local só guarda a
+ * linha), por isso os exemplos usam variáveis static, o que limita cada função a uma única
+ * instância viva. O padrão aqui é declarar o estado que atravessa as esperas em um contexto
+ * tipado cuja primeira parte é a struct pt; a função recebe a struct pt, como nos exemplos, e
+ * recupera o contexto com PT_SELF:
+ *
+ *   PT_CONTEXT(Handler,
+ *       ByteRing *ring;
+ *       unsigned received;
+ *   );
+ *
+ *   static PT_THREAD(handler(struct pt *pt)) {
+ *       Handler *self = PT_SELF(Handler, pt);
+ *       PT_BEGIN(pt);
+ *       ...
+ *       PT_END(pt);
+ *   }
+ *
+ * Variáveis locais comuns continuam valendo entre duas esperas.
+ *
+ * O PtPool guarda N instâncias do mesmo contexto em um vetor contíguo fornecido pelo chamador,
+ * com um mapa de bits das posições ocupadas: ptPoolAlloc devolve uma instância já com a
+ * protothread inicializada e ptPoolRun executa todas as vivas em ordem de endereço (acesso
+ * sequencial à memória), liberando as que terminaram.
+ *
+ *   static Handler handlers[64];
+ *   static uint64_t used[PT_POOL_WORDS(64)];
+ *
+ *   ptPoolInit(&pool, handlers, sizeof(handlers[0]), 64, used);
+ *   Handler *h = ptPoolAlloc(&pool);
+ *   while (ptPoolRun(&pool, handler) > 0) { ... }
+ */
+#ifndef PT_POOL_H
+#define PT_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pt-1.4/pt.h"
+
+/** Declara o tipo de contexto Type: a struct pt seguida dos campos da instância. */
+#define PT_CONTEXT(Type, ...)  \
+    typedef struct Type {      \
+        struct pt pt;          \
+        __VA_ARGS__            \
+    } Type
+
+/** Contexto da protothread pt (a struct pt é o primeiro campo de Type). */
+#define PT_SELF(Type, pt) ((Type *)(pt))
+
+/** Palavras de 64 bits do mapa de ocupação de um pool com capacity instâncias. */
+#define PT_POOL_WORDS(capacity) (((capacity) + 63) / 64)
+
+/** Protothread executada pelo pool sobre cada instância. */
+typedef char (*PtPoolFunction)(struct pt *pt);
+
+typedef struct {
+    uint8_t *storage;     // Instâncias contíguas
+    size_t elementSize;   // sizeof do contexto
+    unsigned capacity;
+    unsigned count;       // Instâncias ocupadas
+    uint64_t *used;       // Bit i: instância i ocupada
+} PtPool;
+
+/** Inicializa o pool vazio sobre capacity contextos de elementSize bytes em storage. */
+void ptPoolInit(PtPool *pool, void *storage, size_t elementSize, unsigned capacity, uint64_t *used);
+
+/**
+ * Reserva a instância livre de menor índice, zera o contexto e inicializa a protothread.
+ * Retorna NULL com o pool cheio.
+ */
+void * ptPoolAlloc(PtPool *pool);
+
+/** Devolve a instância ao pool. */
+void ptPoolFree(PtPool *pool, void *instance);
+
+/** Índice da instância no vetor (identificador estável enquanto ela estiver ocupada). */
+static inline unsigned ptPoolIndex(const PtPool *pool, const void *instance) {
+    return (unsigned)(((const uint8_t *)instance - pool->storage) / pool->elementSize);
+}
+
+/**
+ * Executa function uma vez sobre cada instância ocupada e libera as que terminaram. Retorna
+ * quantas continuam ocupadas.
+ *
+ * A passada segue a ordem dos índices e consulta o mapa de bits à medida que avança: uma
+ * instância alocada por outra durante a passada roda nela se ocupar um índice maior que o da
+ * instância em execução, e só na próxima passada se ocupar uma posição anterior; uma instância
+ * liberada antes de ser alcançada não roda.
+ */
+unsigned ptPoolRun(PtPool *pool, PtPoolFunction function);
+
+#endif // PT_POOL_H
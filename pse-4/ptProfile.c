@@ -0,0 +1,96 @@
+/**
+ * @file ptProfile.c
+ * @brief Implementação do perfil de protothreads descrito em ptProfile.h.
+ */
+#include "ptProfile.h"
+
+#ifdef PT_PROFILE
+
+#include <time.h>
+
+_Thread_local uint64_t ptProfileProgress;
+
+static PtProfile *profiles;   // Perfis já usados, na ordem do primeiro uso
+static uint64_t lastDump;
+
+static uint64_t clockNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+void ptProfileBegin(PtProfile *profile, const struct pt *pt) {
+    if (profile == NULL) {
+        return;
+    }
+    if (!profile->registered) {
+        PtProfile **link = &profiles;
+        while (*link != NULL) {
+            link = &(*link)->next;
+        }
+        *link = profile;
+        profile->registered = true;
+    }
+    profile->lc = pt->lc;
+    profile->progress = ptProfileProgress;
+    profile->start = clockNs();
+}
+
+char ptProfileEnd(PtProfile *profile, const struct pt *pt, char status) {
+    if (profile == NULL) {
+        return status;
+    }
+    profile->runNs += clockNs() - profile->start;
+    profile->invocations++;
+    if (status == PT_WAITING && pt->lc == profile->lc && ptProfileProgress == profile->progress) {
+        profile->wastedPolls++;
+    } else if (status == PT_YIELDED) {
+        profile->yields++;
+    } else if (status >= PT_EXITED) {
+        profile->exits++;
+    }
+    return status;
+}
+
+void ptProfileDump(FILE *out) {
+    uint64_t total = 0;
+
+    for (PtProfile *p = profiles; p != NULL; p = p->next) {
+        total += p->runNs;
+    }
+    // Larguras dos títulos acentuados somam os bytes extras do UTF-8
+    fprintf(out, "%-16s %14s %13s %7s %10s %8s %10s %9s %7s\n", "protothread", "execuções",
+            "inúteis", "%", "yields", "fim", "tempo ms", "ns/exec", "% tempo");
+    for (PtProfile *p = profiles; p != NULL; p = p->next) {
+        uint64_t calls = p->invocations > 0 ? p->invocations : 1;
+        fprintf(out, "%-16s %12llu %12llu %6.1f%% %10llu %8llu %10.3f %9.1f %6.1f%%\n", p->name,
+                (unsigned long long)p->invocations, (unsigned long long)p->wastedPolls,
+                100.0 * (double)p->wastedPolls / (double)calls, (unsigned long long)p->yields,
+                (unsigned long long)p->exits, (double)p->runNs / 1e6,
+                (double)p->runNs / (double)calls,
+                total > 0 ? 100.0 * (double)p->runNs / (double)total : 0.0);
+    }
+}
+
+bool ptProfileDumpEvery(FILE *out, uint32_t intervalMs) {
+    uint64_t now = clockNs();
+
+    if (lastDump == 0) {
+        lastDump = now;
+        return false;
+    }
+    if (now - lastDump < (uint64_t)intervalMs * 1000000u) {
+        return false;
+    }
+    lastDump = now;
+    ptProfileDump(out);
+    return true;
+}
+
+void ptProfileReset(void) {
+    for (PtProfile *p = profiles; p != NULL; p = p->next) {
+        p->invocations = p->wastedPolls = p->yields = p->exits = p->runNs = 0;
+    }
+}
+
+#endif // PT_PROFILE
@@ -0,0 +1,111 @@
+/**
+ * @file ptProfile.h
+ * @brief Perfil de execução de protothreads: execuções, esperas inúteis, yields e tempo.
+ *
+ * Compilando com -DPT_PROFILE, cada PtProfile acumula, para as protothreads associadas a ele:
+ * quantas vezes foram executadas, quantas dessas execuções voltaram à mesma espera sem
+ * progredir (a condição de PT_WAIT_UNTIL foi reavaliada à toa: varredura ociosa), quantas
+ * cederam a vez com PT_YIELD, quantas terminaram e o tempo total de execução. A espera inútil é
+ * uma execução que retornou PT_WAITING com o mesmo lc com que começou sem passar por nenhuma
+ * espera: o lc sozinho não basta, porque um laço que consome um item por execução também
+ * volta à mesma espera. Com a opção, PT_WAIT_UNTIL (e com ele PT_WAIT_WHILE, PT_SEM_WAIT e as
+ * caixas de ptMailbox.h) e as esperas de scheduler.h e reactor.h marcam o progresso com
+ * PT_PROFILE_PROGRESS ao passar da condição. As marcas só existem nas unidades que incluem
+ * este cabeçalho; nas demais, a espera inútil volta a ser decidida só pelo lc.
+ *
+ * No laço de varredura, troque PT_SCHEDULE por PT_PROFILE_SCHEDULE; no escalonador
+ * (scheduler.h), basta apontar task->profile para o perfil depois de taskSpawn. Vários
+ * protothreads (por exemplo, todas as instâncias de uma função) podem somar no mesmo perfil.
+ * ptProfileDumpEvery, chamada no laço principal, imprime a tabela de todos os perfis a cada
+ * intervalo, com a fração do tempo de cada um para localizar quem domina o laço.
+ *
+ *   static PtProfile senderProfile = PT_PROFILE_INIT("sender");
+ *   ...
+ *   PT_PROFILE_SCHEDULE(&senderProfile, &pt, sender(&pt));
+ *   ptProfileDumpEvery(stderr, 1000);
+ *
+ * Sem a opção, PT_PROFILE_SCHEDULE é o próprio PT_SCHEDULE e a instrumentação não gera código
+ * (os PtProfile declarados ficam vazios e sem uso).
+ */
+#ifndef PT_PROFILE_H
+#define PT_PROFILE_H
+
+#include "pt-1.4/pt.h"
+
+#ifdef PT_PROFILE
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+typedef struct PtProfile PtProfile;
+
+struct PtProfile {
+    const char *name;
+    uint64_t invocations;  // Execuções
+    uint64_t wastedPolls;  // Execuções que voltaram à mesma espera sem progredir
+    uint64_t yields;       // Execuções que terminaram em PT_YIELD
+    uint64_t exits;        // Protothreads que terminaram
+    uint64_t runNs;        // Tempo total de execução
+    // Execução em andamento e registro (uso interno)
+    lc_t lc;
+    uint64_t progress;
+    uint64_t start;
+    PtProfile *next;
+    bool registered;
+};
+
+#define PT_PROFILE_INIT(label) { .name = (label) }
+
+/** Esperas vencidas pela thread atual (uso interno de PT_PROFILE_PROGRESS). */
+extern _Thread_local uint64_t ptProfileProgress;
+
+/** Marca que a protothread em execução passou de uma espera. */
+#define PT_PROFILE_PROGRESS() ((void)ptProfileProgress++)
+
+// PT_WAIT_UNTIL de pt.h com a marca de progresso depois da condição
+#undef PT_WAIT_UNTIL
+#define PT_WAIT_UNTIL(pt, condition)    \
+    do {                                \
+        LC_SET((pt)->lc);               \
+        if (!(condition)) {             \
+            return PT_WAITING;          \
+        }                               \
+        PT_PROFILE_PROGRESS();          \
+    } while (0)
+
+/** Marca o início de uma execução da protothread pt (profile pode ser NULL). */
+void ptProfileBegin(PtProfile *profile, const struct pt *pt);
+
+/** Contabiliza a execução iniciada por ptProfileBegin e devolve status. */
+char ptProfileEnd(PtProfile *profile, const struct pt *pt, char status);
+
+/** PT_SCHEDULE contabilizado em profile. */
+#define PT_PROFILE_SCHEDULE(profile, pt, call) \
+    (ptProfileBegin((profile), (pt)), ptProfileEnd((profile), (pt), (call)) < PT_EXITED)
+
+/** Imprime a tabela de todos os perfis já usados. */
+void ptProfileDump(FILE *out);
+
+/** Imprime a tabela se passaram intervalMs desde a última impressão. Retorna se imprimiu. */
+bool ptProfileDumpEvery(FILE *out, uint32_t intervalMs);
+
+/** Zera os contadores de todos os perfis. */
+void ptProfileReset(void);
+
+#else
+
+// Sem a opção, os perfis podem continuar declarados no código, mas não são usados
+typedef struct {
+    char unused;
+} PtProfile;
+
+#define PT_PROFILE_INIT(label)                 { 0 }
+#define PT_PROFILE_PROGRESS()                  ((void)0)
+#define PT_PROFILE_SCHEDULE(profile, pt, call) ((void)(profile), PT_SCHEDULE(call))
+#define ptProfileDumpEvery(out, intervalMs)    ((void)0)
+#define ptProfileDump(out)                     ((void)0)
+
+#endif // PT_PROFILE
+
+#endif // PT_PROFILE_H
@@ -0,0 +1,147 @@
+/**
+ * @file ptScaleBench.c
+ * @brief Milhares de protothreads em ping-pong: trocas de contexto por segundo e memória.
+ *
+ * Cada par de protothreads troca a vez por dois semáforos de pt-sem.h: ping espera toPing e
+ * sinaliza toPong; pong espera toPong e sinaliza toPing. O laço de varredura executa todas as
+ * protothreads a cada volta, então cada execução é uma troca de contexto (entrada pela
+ * continuação local, saída no PT_SEM_WAIT seguinte). No cenário "sem+timer", o pong dorme 1 ms
+ * (PT_SLEEP de ptSleep.h) a cada TIMER_EVERY rodadas, o que mistura esperas por semáforo com
+ * esperas por prazo e reavaliações sem progresso.
+ *
+ * O mesmo fonte é compilado com as duas implementações de continuação local do pt-1.4:
+ * lc-switch.h (padrão, lc_t de 2 bytes) e lc-addrlabels.h (-DLC_INCLUDE="lc-addrlabels.h",
+ * endereço de rótulo do GCC, lc_t de um ponteiro). Relata, por número de protothreads:
+ * execuções/s (trocas), repasses/s (rodadas completadas), ns por troca, sizeof(struct pt) e os
+ * bytes de estado por protothread neste teste (contexto, semáforos e prazo).
+ *
+ *   ptScaleBench [protothreads...]   (padrão 100 1000 10000)
+ */
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "pt-1.4/pt-sem.h"
+#include "ptSleep.h"
+
+#ifdef LC_INCLUDE
+#define BACKEND "lc-addrlabels"
+#else
+#define BACKEND "lc-switch"
+#endif
+
+#define VOLLEYS     2000000 // Rodadas de ping-pong somadas de todos os pares (por cenário)
+#define TIMER_EVERY 64      // Cenário sem+timer: rodadas entre dois PT_SLEEP do pong
+
+typedef struct {
+    TimedPt ping, pong;
+    struct pt_sem toPing, toPong;
+    unsigned pingRound, pongRound, rounds;
+    bool pingDone, pongDone, timers;
+} Pair;
+
+static uint64_t handoffs;
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static PT_THREAD(ping(Pair *p))
+{
+    struct pt *pt = &p->ping.pt;
+
+    PT_BEGIN(pt);
+    for (p->pingRound = 0; p->pingRound < p->rounds; p->pingRound++) {
+        PT_SEM_WAIT(pt, &p->toPing);
+        PT_SEM_SIGNAL(pt, &p->toPong);
+    }
+    PT_END(pt);
+}
+
+static PT_THREAD(pong(Pair *p))
+{
+    struct pt *pt = &p->pong.pt;
+
+    PT_BEGIN(pt);
+    for (p->pongRound = 0; p->pongRound < p->rounds; p->pongRound++) {
+        PT_SEM_WAIT(pt, &p->toPong);
+        if (p->timers && p->pongRound % TIMER_EVERY == TIMER_EVERY - 1) {
+            PT_SLEEP(&p->pong, 1);
+        }
+        handoffs++;
+        PT_SEM_SIGNAL(pt, &p->toPing);
+    }
+    PT_END(pt);
+}
+
+static void run(int threads, bool timers) {
+    int pairs = threads >= 2 ? threads / 2 : 1;
+    Pair *all = calloc((size_t)pairs, sizeof(Pair));
+    unsigned rounds = VOLLEYS / (unsigned)pairs;
+    uint64_t calls = 0;
+    int live = 2 * pairs;
+
+    if (rounds == 0) {
+        rounds = 1;
+    }
+    for (int i = 0; i < pairs; i++) {
+        PT_INIT(&all[i].ping.pt);
+        PT_INIT(&all[i].pong.pt);
+        PT_SEM_INIT(&all[i].toPing, 1);
+        PT_SEM_INIT(&all[i].toPong, 0);
+        all[i].rounds = rounds;
+        all[i].timers = timers;
+    }
+
+    handoffs = 0;
+    double start = now();
+    while (live > 0) {
+        for (int i = 0; i < pairs; i++) {
+            Pair *p = &all[i];
+            // Uma protothread que terminou recomeçaria se fosse chamada de novo
+            if (!p->pingDone) {
+                calls++;
+                if (!PT_SCHEDULE(ping(p))) {
+                    p->pingDone = true;
+                    live--;
+                }
+            }
+            if (!p->pongDone) {
+                calls++;
+                if (!PT_SCHEDULE(pong(p))) {
+                    p->pongDone = true;
+                    live--;
+                }
+            }
+        }
+    }
+    double elapsed = now() - start;
+
+    printf("%-14s %-9s %7d %12.2f %12.2f %9.1f %9zu %9zu\n", BACKEND, timers ? "sem+timer" : "sem",
+           2 * pairs, calls / elapsed / 1e6, handoffs / elapsed / 1e6, elapsed * 1e9 / calls,
+           sizeof(struct pt), sizeof(Pair) / 2);
+    free(all);
+}
+
+int main(int argc, char *argv[]) {
+    static const int defaults[] = {100, 1000, 10000};
+
+    // Larguras dos títulos acentuados somam os bytes extras do UTF-8
+    printf("%-16s %-10s %7s %12s %12s %9s %9s %9s\n", "continuação", "cenário", "threads",
+           "Mtrocas/s", "Mrepasses/s", "ns/troca", "pt bytes", "bytes/pt");
+    for (int timers = 0; timers <= 1; timers++) {
+        if (argc > 1) {
+            for (int i = 1; i < argc; i++) {
+                run(atoi(argv[i]), timers);
+            }
+        } else {
+            for (size_t i = 0; i < sizeof(defaults) / sizeof(defaults[0]); i++) {
+                run(defaults[i], timers);
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,55 @@
+/**
+ * @file ptSleep.h
+ * @brief Espera temporizada por instância de protothread, com relógio monotônico.
+ *
+ * O prazo de PT_SLEEP fica em um TimedPt (struct pt estendida) e não em uma variável estática
+ * da macro: várias instâncias da mesma função de protothread (por exemplo, uma por canal serial)
+ * podem dormir ao mesmo tempo com prazos diferentes. O relógio é o de ptClock.h: CLOCK_MONOTONIC
+ * em milissegundos, imune a ajustes da hora do sistema, ou o relógio virtual das simulações; as
+ * comparações aceitam a volta do contador. Um prazo ainda não vencido é anotado no relógio, para
+ * ptClockIdle esperar (ou saltar) até ele.
+ *
+ * Serve para o laço de varredura comum; com o escalonador de scheduler.h, use PT_SLEEP_MS, que
+ * não reexecuta a tarefa durante a espera.
+ *
+ *   static PT_THREAD(blink(TimedPt *tpt)) {
+ *       PT_BEGIN(&tpt->pt);
+ *       for (;;) {
+ *           PT_SLEEP(tpt, 500);
+ *           ...
+ *       }
+ *       PT_END(&tpt->pt);
+ *   }
+ */
+#ifndef PT_SLEEP_H
+#define PT_SLEEP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "pt-1.4/pt.h"
+#include "ptClock.h"
+
+// Protothread com prazo próprio
+typedef struct {
+    struct pt pt;
+    uint32_t deadline; // Instante (ms) em que o PT_SLEEP atual termina
+} TimedPt;
+
+/** Indica se o prazo da instância já passou; senão o anota como candidato a próximo prazo. */
+static inline bool ptDeadlineReached(const TimedPt *tpt) {
+    if ((int32_t)(ptClockMs() - tpt->deadline) >= 0) {
+        return true;
+    }
+    ptClockNoteDeadline(tpt->deadline);
+    return false;
+}
+
+/** Bloqueia a protothread por ms milissegundos. */
+#define PT_SLEEP(tpt, ms)                                    \
+    do {                                                     \
+        (tpt)->deadline = ptClockMs() + (uint32_t)(ms);      \
+        PT_WAIT_UNTIL(&(tpt)->pt, ptDeadlineReached(tpt));   \
+    } while (0)
+
+#endif // PT_SLEEP_H
@@ -0,0 +1,94 @@
+/**
+ * @file reactor.c
+ * @brief Implementação do reator de epoll descrito em reactor.h.
+ */
+#include <errno.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#include "reactor.h"
+
+#define EVENTS_PER_WAIT 256
+
+/* Sem o lock do escalonador: espera descritores prontos e acorda as suas tarefas */
+static void reactorPoll(void *context, int timeoutMs) {
+    Reactor *reactor = context;
+    struct epoll_event events[EVENTS_PER_WAIT];
+
+    reactor->waits++;
+    int n = epoll_wait(reactor->epoll, events, EVENTS_PER_WAIT, timeoutMs);
+    for (int i = 0; i < n; i++) {
+        if (events[i].data.ptr == reactor) {
+            uint64_t count;
+            if (read(reactor->interruptFd, &count, sizeof(count)) < 0) {
+                // Já zerado por outra leitura: nada a fazer
+            }
+            continue;
+        }
+        reactor->events++;
+        taskUnblock(events[i].data.ptr, TASK_IO);
+    }
+}
+
+/* Com o lock do escalonador, de qualquer thread */
+static void reactorInterrupt(void *context) {
+    Reactor *reactor = context;
+    uint64_t one = 1;
+
+    if (write(reactor->interruptFd, &one, sizeof(one)) < 0) {
+        // Contador do eventfd saturado: a espera já será interrompida
+    }
+}
+
+bool reactorInit(Reactor *reactor, Scheduler *scheduler) {
+    struct epoll_event event = {.events = EPOLLIN, .data.ptr = reactor};
+
+    reactor->scheduler = scheduler;
+    reactor->waits = reactor->events = 0;
+    reactor->epoll = epoll_create1(EPOLL_CLOEXEC);
+    if (reactor->epoll < 0) {
+        return false;
+    }
+    reactor->interruptFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (reactor->interruptFd < 0 ||
+        epoll_ctl(reactor->epoll, EPOLL_CTL_ADD, reactor->interruptFd, &event) < 0) {
+        reactorDestroy(reactor);
+        return false;
+    }
+    reactor->poller.poll = reactorPoll;
+    reactor->poller.interrupt = reactorInterrupt;
+    reactor->poller.context = reactor;
+    schedulerSetPoller(scheduler, &reactor->poller);
+    return true;
+}
+
+void reactorDestroy(Reactor *reactor) {
+    if (reactor->scheduler->poller == &reactor->poller) {
+        schedulerSetPoller(reactor->scheduler, NULL);
+    }
+    if (reactor->interruptFd >= 0) {
+        close(reactor->interruptFd);
+    }
+    close(reactor->epoll);
+}
+
+void reactorForget(Reactor *reactor, int fd) {
+    epoll_ctl(reactor->epoll, EPOLL_CTL_DEL, fd, NULL);
+}
+
+bool reactorWait(Task *task, int fd, uint32_t events) {
+    Reactor *reactor = task->scheduler->poller->context;
+    struct epoll_event event = {.events = events | EPOLLONESHOT, .data.ptr = task};
+
+    // Bloqueia antes de armar: um evento logo após epoll_ctl já encontra a marca para desfazer
+    taskBlock(task, TASK_IO);
+    if (epoll_ctl(reactor->epoll, EPOLL_CTL_MOD, fd, &event) == 0) {
+        return true;
+    }
+    if (errno == ENOENT && epoll_ctl(reactor->epoll, EPOLL_CTL_ADD, fd, &event) == 0) {
+        return true;
+    }
+    taskUnblock(task, TASK_IO);
+    return false;
+}
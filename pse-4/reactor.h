@@ -0,0 +1,86 @@
+/**
+ * @file reactor.h
+ * @brief Reator de epoll para protothreads do escalonador (scheduler.h).
+ *
+ * PT_WAIT_READABLE/PT_WAIT_WRITABLE registram o interesse da tarefa no descritor e a bloqueiam;
+ * ela só volta a ser executada quando o epoll informa que o descritor está pronto, em vez de
+ * ser reexecutada a cada volta para tentar um read/write não bloqueante. O reator é a fonte
+ * externa de eventos do escalonador: com a fila vazia o escalonador espera em epoll_wait (com o
+ * prazo do próximo temporizador) e, com tarefas prontas, consulta o epoll sem esperar uma vez
+ * por rodada. Um eventfd interrompe a espera quando outra thread acorda uma tarefa.
+ *
+ * Cada registro é EPOLLONESHOT e aponta para a tarefa: um descritor é esperado por uma tarefa de
+ * cada vez (a mesma tarefa pode esperar leitura e escrita). O padrão de uso é tentar a operação
+ * e esperar só quando ela retorna EAGAIN, o que evita chamadas ao epoll enquanto há dados:
+ *
+ *   for (;;) {
+ *       n = read(fd, buf, sizeof(buf));
+ *       if (n < 0 && errno == EAGAIN) {
+ *           PT_WAIT_READABLE(task, fd);
+ *           continue;
+ *       }
+ *       ...
+ *   }
+ *
+ * Os descritores devem ser não bloqueantes. Antes de fechar um descritor esperado, chame
+ * reactorForget.
+ */
+#ifndef REACTOR_H
+#define REACTOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/epoll.h>
+
+#include "scheduler.h"
+
+typedef struct {
+    Scheduler *scheduler;
+    SchedulerPoller poller;
+    int epoll;              // Descritor do epoll
+    int interruptFd;        // eventfd que interrompe epoll_wait
+    uint64_t waits;         // Chamadas a epoll_wait
+    uint64_t events;        // Descritores prontos entregues
+} Reactor;
+
+/** Cria o epoll e associa o reator ao escalonador. Retorna false se o sistema recusar. */
+bool reactorInit(Reactor *reactor, Scheduler *scheduler);
+
+void reactorDestroy(Reactor *reactor);
+
+/** Remove o descritor do epoll (antes de fechá-lo). */
+void reactorForget(Reactor *reactor, int fd);
+
+/**
+ * Uso interno de PT_WAIT_READABLE/PT_WAIT_WRITABLE: bloqueia a tarefa e arma o descritor para
+ * events (EPOLLIN/EPOLLOUT). Retorna false se o epoll recusar o descritor (a tarefa não fica
+ * bloqueada).
+ */
+bool reactorWait(Task *task, int fd, uint32_t events);
+
+/**
+ * Bloqueia a tarefa até fd ficar pronto para events. Se o epoll recusar o descritor (EPERM em
+ * um arquivo comum, por exemplo), a tarefa só cede a vez e volta na próxima rodada: o laço de
+ * EAGAIN vira uma consulta por rodada em vez de girar sem fim dentro de uma execução.
+ *
+ * PT_YIELD_FLAG guarda o resultado de reactorWait (2 armado, 0 recusado) e, como em PT_YIELD,
+ * volta a 1 quando PT_BEGIN retoma a tarefa; um único LC_SET, já que com lc-switch duas
+ * continuações na mesma linha de expansão colidiriam.
+ */
+#define PT_WAIT_FD(task, fd, events)                        \
+    do {                                                    \
+        PT_YIELD_FLAG = reactorWait((task), (fd), (events)) ? 2 : 0; \
+        LC_SET((task)->pt.lc);                              \
+        if (PT_YIELD_FLAG == 0) {                           \
+            return PT_YIELDED;                              \
+        }                                                   \
+        if (PT_YIELD_FLAG == 2 && ((task)->flags & TASK_IO)) { \
+            return PT_WAITING;                              \
+        }                                                   \
+        PT_PROFILE_PROGRESS();                              \
+    } while (0)
+
+#define PT_WAIT_READABLE(task, fd) PT_WAIT_FD((task), (fd), EPOLLIN)
+#define PT_WAIT_WRITABLE(task, fd) PT_WAIT_FD((task), (fd), EPOLLOUT)
+
+#endif // REACTOR_H
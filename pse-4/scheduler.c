@@ -0,0 +1,369 @@
+/**
+ * @file scheduler.c
+ * @brief Implementação do escalonador orientado a eventos descrito em scheduler.h.
+ */
+#include <stddef.h>
+#include <time.h>
+
+#include "ptClock.h"
+#include "scheduler.h"
+
+uint32_t schedulerNow(void) {
+    return ptClockMs();
+}
+
+void schedulerInit(Scheduler *scheduler) {
+    pthread_condattr_t attr;
+
+    scheduler->runHead = scheduler->runTail = NULL;
+    scheduler->now = schedulerNow();
+    timerWheelInit(&scheduler->timers, scheduler->now);
+    scheduler->live = 0;
+    scheduler->stopped = false;
+    scheduler->runs = 0;
+    scheduler->idleWaits = 0;
+    scheduler->poller = NULL;
+    scheduler->polling = false;
+    pthread_mutex_init(&scheduler->lock, NULL);
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&scheduler->wake, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+void schedulerSetPoller(Scheduler *scheduler, const SchedulerPoller *poller) {
+    scheduler->poller = poller;
+}
+
+void schedulerDestroy(Scheduler *scheduler) {
+    pthread_mutex_destroy(&scheduler->lock);
+    pthread_cond_destroy(&scheduler->wake);
+}
+
+/* Com o lock: tira o escalonador ocioso da espera */
+static void interrupt(Scheduler *scheduler) {
+    pthread_cond_signal(&scheduler->wake);
+    if (scheduler->polling) {
+        scheduler->poller->interrupt(scheduler->poller->context);
+    }
+}
+
+/* Com o lock: coloca a tarefa no fim da fila de execução */
+static void enqueue(Scheduler *scheduler, Task *task) {
+    if (task->flags & (TASK_QUEUED | TASK_DONE)) {
+        return;
+    }
+    task->flags |= TASK_QUEUED;
+    task->next = NULL;
+    if (scheduler->runTail != NULL) {
+        scheduler->runTail->next = task;
+    } else {
+        scheduler->runHead = task;
+        interrupt(scheduler);
+    }
+    scheduler->runTail = task;
+}
+
+static Task * dequeue(Scheduler *scheduler) {
+    Task *task = scheduler->runHead;
+    if (task != NULL) {
+        scheduler->runHead = task->next;
+        if (scheduler->runHead == NULL) {
+            scheduler->runTail = NULL;
+        }
+        task->flags &= ~TASK_QUEUED;
+    }
+    return task;
+}
+
+void taskSpawn(Scheduler *scheduler, Task *task, TaskFunction function) {
+    PT_INIT(&task->pt);
+    task->function = function;
+    task->scheduler = scheduler;
+    task->next = task->waitNext = NULL;
+    task->waitingOn = NULL;
+    timerInit(&task->timer);
+    task->joiner = NULL;
+    task->result = 0;
+    task->flags = 0;
+#ifdef PT_PROFILE
+    task->profile = NULL;
+#endif
+    pthread_mutex_lock(&scheduler->lock);
+    scheduler->live++;
+    enqueue(scheduler, task);
+    pthread_mutex_unlock(&scheduler->lock);
+}
+
+void taskWake(Task *task) {
+    Scheduler *scheduler = task->scheduler;
+    pthread_mutex_lock(&scheduler->lock);
+    enqueue(scheduler, task);
+    pthread_mutex_unlock(&scheduler->lock);
+}
+
+void taskBlock(Task *task, uint8_t flag) {
+    Scheduler *scheduler = task->scheduler;
+    pthread_mutex_lock(&scheduler->lock);
+    task->flags |= TASK_BLOCKED | flag;
+    pthread_mutex_unlock(&scheduler->lock);
+}
+
+void taskUnblock(Task *task, uint8_t flag) {
+    Scheduler *scheduler = task->scheduler;
+    pthread_mutex_lock(&scheduler->lock);
+    task->flags &= ~(TASK_BLOCKED | flag);
+    enqueue(scheduler, task);
+    pthread_mutex_unlock(&scheduler->lock);
+}
+
+void eventInit(Event *event, Scheduler *scheduler) {
+    event->scheduler = scheduler;
+    event->waiters = NULL;
+}
+
+void eventWait(Event *event, Task *task) {
+    Scheduler *scheduler = event->scheduler;
+    Task **link = &event->waiters;
+
+    pthread_mutex_lock(&scheduler->lock);
+    // Uma execução espúria (acordada durante a execução anterior) já encontra o registro feito
+    if (task->waitingOn != event) {
+        // Fila FIFO: eventSignal acorda quem espera há mais tempo
+        while (*link != NULL) {
+            link = &(*link)->waitNext;
+        }
+        task->waitNext = NULL;
+        task->waitingOn = event;
+        *link = task;
+        task->flags |= TASK_BLOCKED;
+    }
+    pthread_mutex_unlock(&scheduler->lock);
+}
+
+void eventCancel(Event *event, Task *task) {
+    Scheduler *scheduler = event->scheduler;
+
+    pthread_mutex_lock(&scheduler->lock);
+    if (task->waitingOn == event) {
+        Task **link = &event->waiters;
+        while (*link != task) {
+            link = &(*link)->waitNext;
+        }
+        *link = task->waitNext;
+        task->waitingOn = NULL;
+        task->flags &= ~TASK_BLOCKED;
+    }
+    pthread_mutex_unlock(&scheduler->lock);
+}
+
+/* Com o lock: tira a primeira tarefa da lista de espera e a coloca na fila de execução */
+static bool wakeFirst(Event *event) {
+    Task *task = event->waiters;
+    if (task == NULL) {
+        return false;
+    }
+    event->waiters = task->waitNext;
+    task->waitingOn = NULL;
+    task->flags &= ~TASK_BLOCKED;
+    enqueue(event->scheduler, task);
+    return true;
+}
+
+void eventPost(Event *event) {
+    pthread_mutex_lock(&event->scheduler->lock);
+    while (wakeFirst(event)) {
+    }
+    pthread_mutex_unlock(&event->scheduler->lock);
+}
+
+void eventSignal(Event *event) {
+    pthread_mutex_lock(&event->scheduler->lock);
+    wakeFirst(event);
+    pthread_mutex_unlock(&event->scheduler->lock);
+}
+
+void taskSleep(Task *task, uint32_t ms) {
+    Scheduler *scheduler = task->scheduler;
+
+    pthread_mutex_lock(&scheduler->lock);
+    timerAdd(&scheduler->timers, &task->timer, scheduler->now + ms);
+    task->flags |= TASK_BLOCKED | TASK_SLEEPING;
+    pthread_mutex_unlock(&scheduler->lock);
+}
+
+/* Chamada pela roda, com o lock: acorda a tarefa cujo prazo venceu */
+static void wakeSleeper(TimerEntry *entry, void *context) {
+    Task *task = (Task *)((char *)entry - offsetof(Task, timer));
+    task->flags &= ~(TASK_BLOCKED | TASK_SLEEPING);
+    enqueue(context, task);
+}
+
+/* Com o lock: lê o relógio e acorda as tarefas com prazo vencido */
+static void expireTimers(Scheduler *scheduler) {
+    scheduler->now = schedulerNow();
+    timerAdvance(&scheduler->timers, scheduler->now, wakeSleeper, scheduler);
+}
+
+void semaphoreInit(Semaphore *sem, Scheduler *scheduler, unsigned count) {
+    atomic_init(&sem->count, count);
+    eventInit(&sem->event, scheduler);
+}
+
+void semaphoreSignal(Semaphore *sem) {
+    atomic_fetch_add(&sem->count, 1);
+    eventSignal(&sem->event);
+}
+
+bool semaphoreTryAcquire(Semaphore *sem) {
+    unsigned count = atomic_load(&sem->count);
+    while (count > 0) {
+        if (atomic_compare_exchange_weak(&sem->count, &count, count - 1)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool taskJoin(Task *task, Task *child) {
+    Scheduler *scheduler = task->scheduler;
+    bool done;
+
+    pthread_mutex_lock(&scheduler->lock);
+    done = (child->flags & TASK_DONE) != 0;
+    if (!done) {
+        child->joiner = task;
+        task->flags |= TASK_BLOCKED | TASK_JOIN;
+    }
+    pthread_mutex_unlock(&scheduler->lock);
+    return done;
+}
+
+/* Com o lock: executa uma tarefa já retirada da fila */
+static void runTask(Scheduler *scheduler, Task *task) {
+    pthread_mutex_unlock(&scheduler->lock);
+#ifdef PT_PROFILE
+    ptProfileBegin(task->profile, &task->pt);
+    char status = ptProfileEnd(task->profile, &task->pt, task->function(task));
+#else
+    char status = task->function(task);
+#endif
+    pthread_mutex_lock(&scheduler->lock);
+
+    scheduler->runs++;
+    if (status >= PT_EXITED) {
+        task->flags |= TASK_DONE;
+        scheduler->live--;
+        if (task->joiner != NULL) {
+            task->joiner->flags &= ~(TASK_BLOCKED | TASK_JOIN);
+            enqueue(scheduler, task->joiner);
+        }
+    } else if (!(task->flags & TASK_BLOCKED)) {
+        // Cedeu a vez ou espera com PT_WAIT_UNTIL comum: volta para o fim da fila
+        enqueue(scheduler, task);
+    }
+}
+
+/* Com o lock: executa as tarefas prontas no início da rodada; as que voltam para a fila
+ * ficam para a rodada seguinte */
+static unsigned runRound(Scheduler *scheduler) {
+    Task *last = scheduler->runTail;
+    unsigned count = 0;
+
+    while (last != NULL && !scheduler->stopped) {
+        Task *task = dequeue(scheduler);
+        runTask(scheduler, task);
+        count++;
+        if (task == last) {
+            break;
+        }
+    }
+    return count;
+}
+
+/* Com o lock: consulta a fonte externa de eventos, esperando até timeoutMs */
+static void pollEvents(Scheduler *scheduler, int timeoutMs) {
+    scheduler->polling = timeoutMs != 0;
+    pthread_mutex_unlock(&scheduler->lock);
+    scheduler->poller->poll(scheduler->poller->context, timeoutMs);
+    pthread_mutex_lock(&scheduler->lock);
+    scheduler->polling = false;
+}
+
+unsigned schedulerRunReady(Scheduler *scheduler) {
+    pthread_mutex_lock(&scheduler->lock);
+    if (scheduler->poller != NULL) {
+        pollEvents(scheduler, 0);
+    }
+    expireTimers(scheduler);
+    unsigned count = runRound(scheduler);
+    pthread_mutex_unlock(&scheduler->lock);
+    return count;
+}
+
+/* Com o lock: dorme até o próximo prazo, um taskWake/eventPost, um evento externo ou
+ * schedulerStop */
+static void idleWait(Scheduler *scheduler) {
+    scheduler->idleWaits++;
+    if (scheduler->timers.count == 0) {
+        if (scheduler->poller != NULL) {
+            pollEvents(scheduler, -1);
+        } else {
+            pthread_cond_wait(&scheduler->wake, &scheduler->lock);
+        }
+        return;
+    }
+
+    uint32_t delay = timerNextExpiry(&scheduler->timers) - schedulerNow();
+    if ((int32_t)delay <= 0) {
+        return;
+    }
+    if (ptClock.simulated) {
+        // Relógio virtual: salta até o prazo, depois de consultar os eventos externos
+        if (scheduler->poller != NULL) {
+            pollEvents(scheduler, 0);
+        }
+        if (scheduler->runHead == NULL) {
+            ptClockAdvance(delay);
+        }
+        return;
+    }
+    if (scheduler->poller != NULL) {
+        pollEvents(scheduler, (int)delay);
+        return;
+    }
+    struct timespec until;
+    clock_gettime(CLOCK_MONOTONIC, &until);
+    until.tv_sec += delay / 1000;
+    until.tv_nsec += (long)(delay % 1000) * 1000000;
+    if (until.tv_nsec >= 1000000000) {
+        until.tv_sec++;
+        until.tv_nsec -= 1000000000;
+    }
+    pthread_cond_timedwait(&scheduler->wake, &scheduler->lock, &until);
+}
+
+void schedulerRun(Scheduler *scheduler) {
+    pthread_mutex_lock(&scheduler->lock);
+    while (!scheduler->stopped && scheduler->live > 0) {
+        expireTimers(scheduler);
+        if (scheduler->runHead == NULL) {
+            idleWait(scheduler);
+            continue;
+        }
+        runRound(scheduler);
+        if (scheduler->poller != NULL) {
+            // Com tarefas prontas, só consulta os eventos externos, uma vez por rodada
+            pollEvents(scheduler, 0);
+        }
+    }
+    scheduler->stopped = false;
+    pthread_mutex_unlock(&scheduler->lock);
+}
+
+void schedulerStop(Scheduler *scheduler) {
+    pthread_mutex_lock(&scheduler->lock);
+    scheduler->stopped = true;
+    interrupt(scheduler);
+    pthread_mutex_unlock(&scheduler->lock);
+}
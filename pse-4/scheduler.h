@@ -0,0 +1,265 @@
+/**
+ * @file scheduler.h
+ * @brief Escalonador de protothreads orientado a eventos.
+ *
+ * Em vez de um laço que chama todas as protothreads a cada volta (reavaliando condições de
+ * PT_WAIT_UNTIL que não mudaram), cada tarefa só é executada quando está na fila de execução.
+ * Uma tarefa entra na fila quando é criada, quando cede a vez (PT_YIELD) ou quando um evento que
+ * ela espera acontece: um Event postado (por exemplo, chegada de bytes), um Semaphore sinalizado
+ * ou o fim de um PT_SLEEP_MS. Com a fila vazia, o escalonador dorme até o próximo prazo ou até
+ * ser acordado por outra thread, sem consumir CPU.
+ *
+ * Os prazos de PT_SLEEP_MS ficam em uma roda de temporizadores (timerWheel.h) com ticks de 1 ms:
+ * registrar um prazo é O(1) e cada tarefa é acordada uma única vez, no vencimento. O relógio é
+ * lido uma vez por rodada da fila de execução (não a cada tarefa); os prazos contam a partir do
+ * início da rodada em que a tarefa dormiu. Com o relógio virtual de ptClock.h, o escalonador
+ * ocioso salta até o próximo prazo em vez de dormir.
+ *
+ * Protothreads que usam PT_WAIT_UNTIL comum (sem registrar um evento) continuam funcionando:
+ * uma tarefa que retorna PT_WAITING sem estar bloqueada volta para o fim da fila, como no laço
+ * de varredura. Nesse caso o escalonador não dorme enquanto ela existir.
+ *
+ * Eventos podem ser postados de outras threads (no host, o papel das interrupções); a fila e as
+ * listas de espera são protegidas por um mutex, e as tarefas executam sempre na thread que
+ * chama schedulerRun.
+ *
+ * Uma tarefa pode criar tarefas filhas e esperar o fim delas com PT_TASK_SPAWN/PT_TASK_JOIN,
+ * recebendo o valor de PT_TASK_RETURN. Diferente de PT_SPAWN/PT_WAIT_THREAD de pt.h, que
+ * reexecutam a filha a cada execução da mãe (e, numa hierarquia, a subárvore inteira a cada
+ * volta), a filha é uma tarefa da fila como as outras e a mãe fica bloqueada até o fim dela: só
+ * as tarefas prontas são executadas.
+ *
+ * Uma fonte externa de eventos (SchedulerPoller, como o reator de epoll de reactor.h) pode ser
+ * associada ao escalonador: ele a consulta sem esperar uma vez por rodada e, com a fila vazia,
+ * espera nela em vez de na variável de condição.
+ *
+ * Uso:
+ *
+ *   static PT_THREAD(consumer(Task *task)) {
+ *       PT_BEGIN(&task->pt);
+ *       for (;;) {
+ *           PT_SEM_ACQUIRE(task, &items);
+ *           ...
+ *       }
+ *       PT_END(&task->pt);
+ *   }
+ *
+ *   schedulerInit(&scheduler);
+ *   taskSpawn(&scheduler, &consumerTask, consumer);
+ *   schedulerRun(&scheduler);
+ */
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "pt-1.4/pt.h"
+#include "ptProfile.h"
+#include "timerWheel.h"
+
+typedef struct Task Task;
+typedef struct Scheduler Scheduler;
+
+/** Corpo de uma tarefa: uma protothread que recebe a própria tarefa. */
+typedef char (*TaskFunction)(Task *task);
+
+// Estados de uma tarefa (Task.flags)
+#define TASK_QUEUED   0x01 // Na fila de execução
+#define TASK_BLOCKED  0x02 // Registrada em um evento ou temporizador
+#define TASK_SLEEPING 0x04 // Esperando o fim de um PT_SLEEP_MS
+#define TASK_DONE     0x08 // Protothread terminou
+#define TASK_IO       0x10 // Esperando um descritor de arquivo (reactor.h)
+#define TASK_JOIN     0x20 // Esperando o fim de uma tarefa filha (PT_TASK_JOIN)
+
+struct Task {
+    struct pt pt;
+    TaskFunction function;
+    Scheduler *scheduler;
+    Task *next;        // Fila de execução
+    Task *waitNext;    // Lista de espera do evento waitingOn
+    void *waitingOn;   // Evento em que a tarefa está registrada (NULL = nenhum)
+    TimerEntry timer;  // Prazo de PT_SLEEP_MS (ms)
+    Task *joiner;      // Tarefa esperando o fim desta em PT_TASK_JOIN (NULL = nenhuma)
+    intptr_t result;   // Valor entregue por PT_TASK_RETURN
+    uint8_t flags;
+#ifdef PT_PROFILE
+    PtProfile *profile; // Perfil de execução (NULL = sem perfil; ver ptProfile.h)
+#endif
+};
+
+// Lista de tarefas esperando um acontecimento
+typedef struct {
+    Scheduler *scheduler;
+    Task *waiters;
+} Event;
+
+// Semáforo contador cuja espera bloqueia a tarefa até um sinal
+typedef struct {
+    atomic_uint count;
+    Event event;
+} Semaphore;
+
+/**
+ * Fonte externa de eventos consultada pelo escalonador (por exemplo, o reator de epoll de
+ * reactor.h). Com ela, o escalonador ocioso espera dentro de poll em vez da variável de condição.
+ */
+typedef struct {
+    /**
+     * Chamada sem o lock: espera eventos por até timeoutMs (-1: sem limite; 0: só consulta) e
+     * acorda as tarefas prontas com taskUnblock.
+     */
+    void (*poll)(void *context, int timeoutMs);
+    /** Chamada com o lock, de qualquer thread: faz um poll em andamento retornar. */
+    void (*interrupt)(void *context);
+    void *context;
+} SchedulerPoller;
+
+struct Scheduler {
+    Task *runHead, *runTail; // Fila de execução
+    TimerWheel timers;       // Prazos das tarefas dormindo
+    uint32_t now;            // Instante (ms) lido no início da rodada atual
+    unsigned live;           // Tarefas ainda não terminadas
+    bool stopped;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;     // Sinalizada quando a fila deixa de estar vazia
+    const SchedulerPoller *poller; // Fonte externa de eventos (NULL = nenhuma)
+    bool polling;            // Ocioso dentro de poller->poll
+    uint64_t runs;           // Execuções de tarefas
+    uint64_t idleWaits;      // Vezes em que o escalonador dormiu sem nada a executar
+};
+
+/** Inicializa o escalonador sem tarefas. */
+void schedulerInit(Scheduler *scheduler);
+
+/** Libera os recursos do escalonador (as tarefas pertencem ao chamador). */
+void schedulerDestroy(Scheduler *scheduler);
+
+/** Associa uma fonte externa de eventos (antes de schedulerRun). */
+void schedulerSetPoller(Scheduler *scheduler, const SchedulerPoller *poller);
+
+/**
+ * Executa tarefas até todas terminarem ou schedulerStop ser chamado. Dorme quando não há
+ * tarefas prontas.
+ */
+void schedulerRun(Scheduler *scheduler);
+
+/** Executa as tarefas prontas neste momento, sem dormir. Retorna quantas foram executadas. */
+unsigned schedulerRunReady(Scheduler *scheduler);
+
+/** Faz schedulerRun retornar (pode ser chamada de qualquer thread ou de uma tarefa). */
+void schedulerStop(Scheduler *scheduler);
+
+/** Tempo em milissegundos usado pelos temporizadores: ptClockMs (ptClock.h), real ou virtual. */
+uint32_t schedulerNow(void);
+
+/** Inicializa a protothread da tarefa e a coloca na fila de execução. */
+void taskSpawn(Scheduler *scheduler, Task *task, TaskFunction function);
+
+/** Coloca a tarefa na fila de execução se ainda não estiver (qualquer thread). */
+void taskWake(Task *task);
+
+void eventInit(Event *event, Scheduler *scheduler);
+
+/** Acorda todas as tarefas que esperam o evento (qualquer thread). */
+void eventPost(Event *event);
+
+/** Acorda a tarefa que espera o evento há mais tempo, se houver (qualquer thread). */
+void eventSignal(Event *event);
+
+/** Uso interno de PT_WAIT_EVENT: registra / cancela a espera da tarefa. */
+void eventWait(Event *event, Task *task);
+void eventCancel(Event *event, Task *task);
+
+/**
+ * Para extensões do escalonador (como reactor.c): marca a tarefa como bloqueada pelo motivo
+ * flag / desfaz a marca e coloca a tarefa na fila (qualquer thread).
+ */
+void taskBlock(Task *task, uint8_t flag);
+void taskUnblock(Task *task, uint8_t flag);
+
+/**
+ * Uso interno de PT_TASK_JOIN: retorna true se child terminou; senão registra task como a
+ * tarefa que espera child (uma por filha) e a bloqueia.
+ */
+bool taskJoin(Task *task, Task *child);
+
+/** Uso interno de PT_SLEEP_MS: registra o temporizador da tarefa. */
+void taskSleep(Task *task, uint32_t ms);
+
+void semaphoreInit(Semaphore *sem, Scheduler *scheduler, unsigned count);
+
+/** Incrementa o semáforo e acorda uma tarefa que o espera (qualquer thread). */
+void semaphoreSignal(Semaphore *sem);
+
+/** Decrementa o semáforo se ele for positivo. */
+bool semaphoreTryAcquire(Semaphore *sem);
+
+/**
+ * Bloqueia a tarefa até condition ser verdadeira. A tarefa só é reexecutada quando event é
+ * postado; condition é reavaliada depois do registro, então um evento postado por outra thread
+ * entre o teste e o registro não é perdido. Uma execução retomada (PT_YIELD_FLAG voltou a 1)
+ * que já encontra condition verdadeira, acordada por taskWake ou pelo poller, ainda pode estar
+ * na lista de event: o registro é cancelado para não gastar o próximo eventSignal.
+ */
+#define PT_WAIT_EVENT(task, event, condition)    \
+    do {                                         \
+        PT_YIELD_FLAG = 0;                       \
+        LC_SET((task)->pt.lc);                   \
+        if (!(condition)) {                      \
+            eventWait((event), (task));          \
+            if (!(condition)) {                  \
+                return PT_WAITING;               \
+            }                                    \
+            eventCancel((event), (task));        \
+        } else if (PT_YIELD_FLAG) {              \
+            eventCancel((event), (task));        \
+        }                                        \
+        PT_PROFILE_PROGRESS();                   \
+    } while (0)
+
+/** Bloqueia a tarefa até o semáforo ser positivo e o decrementa. */
+#define PT_SEM_ACQUIRE(task, sem) \
+    PT_WAIT_EVENT((task), &(sem)->event, semaphoreTryAcquire(sem))
+
+/** Bloqueia a tarefa por ms milissegundos sem ser executada nesse intervalo. */
+#define PT_SLEEP_MS(task, ms)                    \
+    do {                                         \
+        taskSleep((task), (ms));                 \
+        LC_SET((task)->pt.lc);                   \
+        if ((task)->flags & TASK_SLEEPING) {     \
+            return PT_WAITING;                   \
+        }                                        \
+        PT_PROFILE_PROGRESS();                   \
+    } while (0)
+
+/**
+ * Bloqueia a tarefa até child terminar; o valor entregue pela filha fica em child->result. A
+ * tarefa só é reexecutada quando a filha termina.
+ */
+#define PT_TASK_JOIN(task, child)                \
+    do {                                         \
+        LC_SET((task)->pt.lc);                   \
+        if (!taskJoin((task), (child))) {        \
+            return PT_WAITING;                   \
+        }                                        \
+        PT_PROFILE_PROGRESS();                   \
+    } while (0)
+
+/** Cria child como tarefa do mesmo escalonador e espera o fim dela. */
+#define PT_TASK_SPAWN(task, child, function)                 \
+    do {                                                     \
+        taskSpawn((task)->scheduler, (child), (function));   \
+        PT_TASK_JOIN((task), (child));                       \
+    } while (0)
+
+/** Termina a tarefa entregando value (inteiro ou ponteiro) a quem a espera em PT_TASK_JOIN. */
+#define PT_TASK_RETURN(task, value)              \
+    do {                                         \
+        (task)->result = (intptr_t)(value);      \
+        PT_EXIT(&(task)->pt);                    \
+    } while (0)
+
+#endif // SCHEDULER_H
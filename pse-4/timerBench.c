@@ -0,0 +1,183 @@
+/**
+ * @file timerBench.c
+ * @brief Medição da roda de temporizadores e de milhares de protothreads dormindo.
+ *
+ * 1. Roda isolada: custo de timerAdd e de timerAdvance (por temporizador vencido) com
+ *    TEMPORIZADORES prazos aleatórios de até um minuto.
+ * 2. Escalonador: N protothreads repetem RODADAS vezes PT_SLEEP_MS com intervalos aleatórios de
+ *    1 a 50 ms. Mede CPU, execuções e atraso médio do acordar em relação ao prazo.
+ * 3. Varredura: a mesma carga no laço que chama todas as protothreads a cada volta, com o
+ *    PT_SLEEP antigo (PT_WAIT_UNTIL sobre o relógio, agora em ms). Mede CPU, condições avaliadas e
+ *    leituras do relógio.
+ *
+ *   timerBench [protothreads]   (padrão 10000)
+ */
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "scheduler.h"
+#include "timerWheel.h"
+
+#define TEMPORIZADORES 1000000
+#define RODADAS        20
+#define MAX_SONO       50
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static double cpuTime(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static long expired;
+
+static void countExpired(TimerEntry *entry, void *context) {
+    (void)entry;
+    (void)context;
+    expired++;
+}
+
+static void benchWheel(void) {
+    static TimerWheel wheel;
+    TimerEntry *timers = malloc(TEMPORIZADORES * sizeof(TimerEntry));
+    double start;
+
+    srand(1);
+    timerWheelInit(&wheel, 0);
+    start = now();
+    for (int i = 0; i < TEMPORIZADORES; i++) {
+        timerInit(&timers[i]);
+        timerAdd(&wheel, &timers[i], 1 + (uint32_t)rand() % 60000);
+    }
+    double add = now() - start;
+
+    start = now();
+    for (uint32_t tick = 0; wheel.count > 0; tick += 10) {
+        timerAdvance(&wheel, tick, countExpired, NULL);
+    }
+    double advance = now() - start;
+
+    printf("roda: %d temporizadores, timerAdd %.1f ns, vencimento %.1f ns por temporizador\n",
+           TEMPORIZADORES, add * 1e9 / TEMPORIZADORES, advance * 1e9 / expired);
+    free(timers);
+}
+
+typedef struct {
+    Task task;
+    int round;
+    uint32_t deadline;
+    uint64_t lateness; // Soma dos atrasos do acordar (ms)
+} Sleeper;
+
+static PT_THREAD(sleeper(Task *task))
+{
+    Sleeper *self = (Sleeper *)task;
+
+    PT_BEGIN(&task->pt);
+    for (self->round = 0; self->round < RODADAS; self->round++) {
+        uint32_t ms = 1 + (uint32_t)rand() % MAX_SONO;
+        self->deadline = task->scheduler->now + ms;
+        PT_SLEEP_MS(task, ms);
+        self->lateness += task->scheduler->now - self->deadline;
+    }
+    PT_END(&task->pt);
+}
+
+static void benchScheduler(int count) {
+    Scheduler scheduler;
+    Sleeper *sleepers = calloc((size_t)count, sizeof(Sleeper));
+    uint64_t lateness = 0;
+
+    srand(2);
+    schedulerInit(&scheduler);
+    for (int i = 0; i < count; i++) {
+        taskSpawn(&scheduler, &sleepers[i].task, sleeper);
+    }
+    double wall = now(), cpu = cpuTime();
+    schedulerRun(&scheduler);
+    wall = now() - wall;
+    cpu = cpuTime() - cpu;
+
+    for (int i = 0; i < count; i++) {
+        lateness += sleepers[i].lateness;
+    }
+    printf("escalonador: %d protothreads, %.2f s, CPU %.3f s (%.1f%%), %llu execuções, "
+           "%llu esperas ociosas, atraso médio %.2f ms\n", count, wall, cpu, 100 * cpu / wall,
+           (unsigned long long)scheduler.runs, (unsigned long long)scheduler.idleWaits,
+           (double)lateness / ((double)count * RODADAS));
+    schedulerDestroy(&scheduler);
+    free(sleepers);
+}
+
+/* Varredura com o PT_SLEEP antigo: a condição lê o relógio a cada avaliação */
+static long evaluations;
+
+static uint32_t pollClock(void) {
+    evaluations++;
+    return schedulerNow();
+}
+
+typedef struct {
+    struct pt pt;
+    int round;
+    uint32_t start, ms;
+    bool done;
+} PollSleeper;
+
+static PT_THREAD(pollSleeper(PollSleeper *self))
+{
+    PT_BEGIN(&self->pt);
+    for (self->round = 0; self->round < RODADAS; self->round++) {
+        self->ms = 1 + (uint32_t)rand() % MAX_SONO;
+        self->start = schedulerNow();
+        PT_WAIT_UNTIL(&self->pt, pollClock() - self->start >= self->ms);
+    }
+    PT_END(&self->pt);
+}
+
+static void benchPolling(int count) {
+    PollSleeper *sleepers = calloc((size_t)count, sizeof(PollSleeper));
+    int live = count;
+    long passes = 0;
+
+    srand(2);
+    for (int i = 0; i < count; i++) {
+        PT_INIT(&sleepers[i].pt);
+    }
+    double wall = now(), cpu = cpuTime();
+    while (live > 0) {
+        live = 0;
+        for (int i = 0; i < count; i++) {
+            // Uma protothread que terminou recomeçaria se fosse chamada de novo
+            if (!sleepers[i].done) {
+                sleepers[i].done = !PT_SCHEDULE(pollSleeper(&sleepers[i]));
+                live += !sleepers[i].done;
+            }
+        }
+        passes++;
+    }
+    wall = now() - wall;
+    cpu = cpuTime() - cpu;
+
+    printf("varredura:   %d protothreads, %.2f s, CPU %.3f s (%.1f%%), %ld voltas, "
+           "%ld condições avaliadas (e leituras do relógio)\n", count, wall, cpu, 100 * cpu / wall,
+           passes, evaluations);
+    free(sleepers);
+}
+
+int main(int argc, char *argv[]) {
+    int count = argc > 1 ? atoi(argv[1]) : 10000;
+
+    benchWheel();
+    benchScheduler(count);
+    benchPolling(count);
+    return 0;
+}
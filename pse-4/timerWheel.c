@@ -0,0 +1,183 @@
+/**
+ * @file timerWheel.c
+ * @brief Implementação da roda de temporizadores descrita em timerWheel.h.
+ */
+#include "timerWheel.h"
+
+#define ROOT_MASK  (WHEEL_ROOT_SIZE - 1)
+#define LEVEL_MASK (WHEEL_LEVEL_SIZE - 1)
+
+// Deslocamento do índice de posição no nível dado (1 a 3)
+#define LEVEL_SHIFT(level) (WHEEL_ROOT_BITS + ((level) - 1) * WHEEL_LEVEL_BITS)
+
+static inline void listInit(TimerEntry *head) {
+    head->next = head->prev = head;
+}
+
+static inline void listAppend(TimerEntry *head, TimerEntry *entry) {
+    entry->prev = head->prev;
+    entry->next = head;
+    head->prev->next = entry;
+    head->prev = entry;
+}
+
+static inline bool isRootHead(const TimerWheel *wheel, const TimerEntry *head) {
+    return head >= wheel->root && head < wheel->root + WHEEL_ROOT_SIZE;
+}
+
+void timerWheelInit(TimerWheel *wheel, uint32_t now) {
+    for (int i = 0; i < WHEEL_ROOT_SIZE; i++) {
+        listInit(&wheel->root[i]);
+    }
+    for (int level = 0; level < WHEEL_LEVELS - 1; level++) {
+        for (int i = 0; i < WHEEL_LEVEL_SIZE; i++) {
+            listInit(&wheel->levels[level][i]);
+        }
+    }
+    for (int i = 0; i < WHEEL_ROOT_SIZE / 64; i++) {
+        wheel->rootBits[i] = 0;
+    }
+    wheel->next = now + 1;
+    wheel->count = 0;
+}
+
+void timerInit(TimerEntry *entry) {
+    entry->next = entry->prev = NULL;
+}
+
+/* Coloca o temporizador na posição correspondente à distância do prazo */
+static void place(TimerWheel *wheel, TimerEntry *entry) {
+    uint32_t delta = entry->expires - wheel->next;
+    TimerEntry *head;
+
+    if ((int32_t)delta < 0) {
+        entry->expires = wheel->next;
+        delta = 0;
+    } else if (delta > WHEEL_MAX_DELAY) {
+        entry->expires = wheel->next + WHEEL_MAX_DELAY;
+        delta = WHEEL_MAX_DELAY;
+    }
+
+    if (delta < WHEEL_ROOT_SIZE) {
+        unsigned slot = entry->expires & ROOT_MASK;
+        wheel->rootBits[slot / 64] |= 1ull << (slot % 64);
+        head = &wheel->root[slot];
+    } else {
+        int level = 1;
+        while (level < WHEEL_LEVELS - 1 && delta >> LEVEL_SHIFT(level + 1) != 0) {
+            level++;
+        }
+        head = &wheel->levels[level - 1][(entry->expires >> LEVEL_SHIFT(level)) & LEVEL_MASK];
+    }
+    listAppend(head, entry);
+}
+
+void timerAdd(TimerWheel *wheel, TimerEntry *entry, uint32_t expires) {
+    if (timerActive(entry)) {
+        timerRemove(wheel, entry);
+    }
+    entry->expires = expires;
+    place(wheel, entry);
+    wheel->count++;
+}
+
+void timerRemove(TimerWheel *wheel, TimerEntry *entry) {
+    if (!timerActive(entry)) {
+        return;
+    }
+    TimerEntry *prev = entry->prev, *next = entry->next;
+    prev->next = next;
+    next->prev = prev;
+    // Lista do nível 0 que ficou vazia: a cabeça é prev e next ao mesmo tempo
+    if (prev == next && isRootHead(wheel, prev)) {
+        unsigned slot = (unsigned)(prev - wheel->root);
+        wheel->rootBits[slot / 64] &= ~(1ull << (slot % 64));
+    }
+    entry->next = entry->prev = NULL;
+    wheel->count--;
+}
+
+/* Redistribui a posição atual de cada nível acima, começando pelo nível 1 */
+static void cascade(TimerWheel *wheel) {
+    for (int level = 1; level < WHEEL_LEVELS; level++) {
+        unsigned slot = (wheel->next >> LEVEL_SHIFT(level)) & LEVEL_MASK;
+        TimerEntry *head = &wheel->levels[level - 1][slot];
+        TimerEntry *entry = head->next;
+
+        listInit(head);
+        while (entry != head) {
+            TimerEntry *following = entry->next;
+            place(wheel, entry);
+            entry = following;
+        }
+        if (slot != 0) {
+            break;
+        }
+    }
+}
+
+/* Próximo tick >= next com temporizador no nível 0, sem passar da volta do índice.
+ * Sem nenhum, *tick recebe a volta (próximo cascateamento) e retorna false. */
+static bool nextRootTick(const TimerWheel *wheel, uint32_t *tick) {
+    unsigned index = wheel->next & ROOT_MASK;
+
+    for (unsigned word = index / 64; word < WHEEL_ROOT_SIZE / 64; word++) {
+        uint64_t bits = wheel->rootBits[word];
+        if (word == index / 64) {
+            bits &= ~0ull << (index % 64);
+        }
+        if (bits != 0) {
+            *tick = wheel->next + (word * 64 + (unsigned)__builtin_ctzll(bits) - index);
+            return true;
+        }
+    }
+    *tick = wheel->next + (WHEEL_ROOT_SIZE - index);
+    return false;
+}
+
+void timerAdvance(TimerWheel *wheel, uint32_t now, TimerCallback callback, void *context) {
+    while ((int32_t)(now - wheel->next) >= 0) {
+        uint32_t tick;
+
+        if ((wheel->next & ROOT_MASK) == 0) {
+            cascade(wheel);
+        }
+        // Salta direto para o próximo tick com temporizadores (ou para o próximo cascateamento)
+        bool found = nextRootTick(wheel, &tick);
+        if ((int32_t)(now - tick) < 0) {
+            wheel->next = now + 1;
+            break;
+        }
+        wheel->next = tick;
+        if (!found) {
+            continue;
+        }
+
+        // Destaca a lista antes das chamadas, que podem reagendar temporizadores
+        unsigned slot = tick & ROOT_MASK;
+        TimerEntry *head = &wheel->root[slot];
+        TimerEntry *entry = head->next;
+        head->prev->next = NULL;
+        listInit(head);
+        wheel->rootBits[slot / 64] &= ~(1ull << (slot % 64));
+        wheel->next = tick + 1;
+
+        while (entry != NULL) {
+            TimerEntry *following = entry->next;
+            entry->next = entry->prev = NULL;
+            wheel->count--;
+            callback(entry, context);
+            entry = following;
+        }
+    }
+}
+
+uint32_t timerNextExpiry(const TimerWheel *wheel) {
+    uint32_t tick;
+
+    if (wheel->count == 0) {
+        return wheel->next - 1 + WHEEL_MAX_DELAY;
+    }
+    nextRootTick(wheel, &tick);
+    return tick;
+}
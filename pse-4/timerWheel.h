@@ -0,0 +1,78 @@
+/**
+ * @file timerWheel.h
+ * @brief Roda de temporizadores hierárquica com ticks de 1 ms.
+ *
+ * Quatro níveis de posições (256, 64, 64 e 64): o nível 0 tem uma posição por tick e cada nível
+ * acima cobre 64 posições do nível anterior, o que alcança 2^26 ms (cerca de 18 horas); prazos
+ * mais distantes são limitados a esse alcance. Inserir e remover um temporizador é O(1): a
+ * posição é calculada pelos bits do prazo e as listas são duplamente encadeadas. timerAdvance
+ * processa um tick por vez e, quando o índice do nível 0 dá a volta, redistribui (cascateia) uma
+ * posição do nível acima; cada temporizador é movido no máximo uma vez por nível.
+ *
+ * Os temporizadores são intrusivos (TimerEntry embutido na estrutura do usuário) e a roda não
+ * lê relógio algum: o tempo é informado pelo chamador em timerAdvance.
+ */
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define WHEEL_LEVELS     4
+#define WHEEL_ROOT_BITS  8
+#define WHEEL_LEVEL_BITS 6
+#define WHEEL_ROOT_SIZE  (1 << WHEEL_ROOT_BITS)
+#define WHEEL_LEVEL_SIZE (1 << WHEEL_LEVEL_BITS)
+
+// Maior intervalo representável (ticks)
+#define WHEEL_MAX_DELAY ((1u << (WHEEL_ROOT_BITS + (WHEEL_LEVELS - 1) * WHEEL_LEVEL_BITS)) - 1)
+
+typedef struct TimerEntry TimerEntry;
+
+struct TimerEntry {
+    TimerEntry *next, *prev; // Lista da posição (prev == NULL: temporizador inativo)
+    uint32_t expires;        // Tick do prazo
+};
+
+typedef struct {
+    TimerEntry root[WHEEL_ROOT_SIZE];                      // Cabeças de lista do nível 0
+    TimerEntry levels[WHEEL_LEVELS - 1][WHEEL_LEVEL_SIZE]; // Cabeças dos níveis 1 a 3
+    uint64_t rootBits[WHEEL_ROOT_SIZE / 64];               // Posições não vazias do nível 0
+    uint32_t next;                                         // Próximo tick a processar
+    unsigned count;                                        // Temporizadores ativos
+} TimerWheel;
+
+/** Chamada por timerAdvance para cada temporizador vencido (já removido da roda). */
+typedef void (*TimerCallback)(TimerEntry *entry, void *context);
+
+/** Inicializa a roda vazia no tick now. */
+void timerWheelInit(TimerWheel *wheel, uint32_t now);
+
+/** Marca um temporizador como inativo (antes do primeiro timerAdd). */
+void timerInit(TimerEntry *entry);
+
+/**
+ * Agenda o temporizador para o tick expires. Um prazo já processado vence no próximo tick; um
+ * prazo além de WHEEL_MAX_DELAY é antecipado para esse limite.
+ */
+void timerAdd(TimerWheel *wheel, TimerEntry *entry, uint32_t expires);
+
+/** Cancela o temporizador, se ativo. */
+void timerRemove(TimerWheel *wheel, TimerEntry *entry);
+
+static inline bool timerActive(const TimerEntry *entry) {
+    return entry->prev != NULL;
+}
+
+/** Processa os ticks até now, chamando callback para cada temporizador vencido. */
+void timerAdvance(TimerWheel *wheel, uint32_t now, TimerCallback callback, void *context);
+
+/**
+ * Limite inferior do próximo prazo: exato quando ele está no nível 0; senão, o tick do próximo
+ * cascateamento (no máximo WHEEL_ROOT_SIZE ticks adiante). Com a roda vazia, o último tick
+ * processado mais WHEEL_MAX_DELAY.
+ */
+uint32_t timerNextExpiry(const TimerWheel *wheel);
+
+#endif // TIMER_WHEEL_H
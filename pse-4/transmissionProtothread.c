@@ -1,112 +1,127 @@
+#include <stdbool.h>
 #include <stdio.h>
-#include <time.h>
-#include "pt-1.4/pt.h"
-
-#define TIMEOUT 5    // Tempo máximo de espera em segundos
-#define DATA_SIZE 10 // Tamanho dos dados a serem enviados
-
-// Definição da macro PT_SLEEP
-#define PT_SLEEP(pt, seconds)                                     \
-    do {                                                          \
-        static time_t sleep_start;                                \
-        sleep_start = time(NULL);                                 \
-        PT_WAIT_UNTIL(pt, time(NULL) - sleep_start >= (seconds)); \
-    } while (0)
-
-static struct pt pt_sender, pt_receiver;
-static int data_buffer[DATA_SIZE];
-static int ack_flag = 0;
-
-// Protothread Sender
-static PT_THREAD(sender(struct pt *pt))
+#include <stdlib.h>
+#include <string.h>
+#include "arq.h"
+#include "bulkPipe.h"
+#include "lossyLink.h"
+#include "ptClock.h"
+#include "ptProfile.h"
+
+#define TIMEOUT 3      // Tempo máximo de espera inicial em segundos (RTO antes da primeira medida)
+#define DATA_SIZE 10   // Tamanho dos dados a serem enviados (inteiros por quadro)
+#define BUFFERS 5      // Buffers enviados por canal
+#define CHANNELS 4     // Canais simulados (padrão; o argumento canais muda)
+#define LOSS 100       // Perda de quadros nos enlaces (por mil)
+
+_Static_assert(DATA_SIZE * sizeof(int) <= ARQ_PAYLOAD, "DATA_SIZE maior que um quadro do ARQ");
+
+// Estado de um canal: transmissor e receptor com ARQ stop-and-wait sobre um enlace com perdas
+typedef struct {
+    ArqSender sender;
+    ArqReceiver receiver;
+    LossyLink data, acks;   // Transmissor -> receptor / receptor -> transmissor
+    int id;
+    uint64_t timeouts;      // Vencimentos já informados
+    bool sender_done;
+} Channel;
+
+// Perfis de execução (com -DPT_PROFILE): somam todas as instâncias de cada função
+static PtProfile sender_profile = PT_PROFILE_INIT("sender");
+static PtProfile receiver_profile = PT_PROFILE_INIT("receiver");
+
+// Transmissor: preparar dados para envio, escritos direto no quadro
+static uint16_t fill(void *context, uint32_t seq, uint8_t *data)
 {
-    static int index;
-    static int timeout_counter;
-
-    PT_BEGIN(pt);
-
-    // Preparar dados para envio
-    for (index = 0; index < DATA_SIZE; index++)
-    {
-        data_buffer[index] = index;
-    }
+    Channel *ch = context;
 
-    printf("Transmissor: Enviando dados...\n");
-
-    // Enviar dados para o receptor (simulação)
-    ack_flag = 0; // Resetar o ACK
+    bulkFill(data, DATA_SIZE, (int)seq * DATA_SIZE);
+    printf("Transmissor %d: Enviando dados (buffer %u)...\n", ch->id, seq);
+    return DATA_SIZE * sizeof(int);
+}
 
-    // Esperar pelo ACK ou timeout
-    timeout_counter = 0;
-    while (ack_flag == 0 && timeout_counter < TIMEOUT)
-    {
-        PT_SLEEP(pt, 1); // Espera de 1 segundo
-        timeout_counter++;
-    }
+// Receptor: copiar e verificar os dados em uma única passagem; o ARQ envia o ACK em seguida
+static void deliver(void *context, uint32_t seq, const uint8_t *data, uint16_t length)
+{
+    Channel *ch = context;
+    int received_data[DATA_SIZE];
+    bool data_valid = length == sizeof(received_data) &&
+                      bulkCopyValidate(received_data, data, DATA_SIZE, (int)seq * DATA_SIZE);
 
-    if (ack_flag)
+    if (data_valid)
     {
-        printf("Transmissor: ACK recebido.\n");
+        printf("Receptor %d: Dados corretos (buffer %u). Enviando ACK...\n", ch->id, seq);
     }
     else
     {
-        printf("Transmissor: Timeout. Reenviando dados...\n");
-        // Reenviar dados
+        printf("Receptor %d: Dados incorretos (buffer %u).\n", ch->id, seq);
     }
-
-    PT_END(pt);
 }
 
-// Protothread Receiver
-static PT_THREAD(receiver(struct pt *pt))
+// Função principal: transmissionProtothread [-s] [canais]; -s simula com o relógio virtual
+int main(int argc, char *argv[])
 {
-    static int index;
-    static int received_data[DATA_SIZE];
-    static int data_valid = 1;
+    bool simulate = argc > 1 && strcmp(argv[1], "-s") == 0;
+    int count = argc > 1 + simulate ? atoi(argv[1 + simulate]) : CHANNELS;
+    Channel *channels = calloc((size_t)(count > 0 ? count : 1), sizeof(Channel));
+    int live = count;
 
-    PT_BEGIN(pt);
-
-    // Simular recepção de dados
-    PT_SLEEP(pt, 2); // Simula o tempo de chegada dos dados
-
-    // Receber dados do transmissor
-    for (index = 0; index < DATA_SIZE; index++)
+    if (simulate)
     {
-        received_data[index] = data_buffer[index];
+        ptClockSimulate(0);
     }
 
-    // Verificar se os dados estão corretos
-    data_valid = 1;
-    for (index = 0; index < DATA_SIZE; index++)
+    // Latência de 100, 200, 300 e 400 ms por sentido; a semente das perdas é o canal
+    for (int i = 0; i < count; i++)
     {
-        if (received_data[index] != index)
-        {
-            data_valid = 0;
-            break;
-        }
+        Channel *ch = &channels[i];
+        ch->id = i;
+        linkInit(&ch->data, 100 * (uint32_t)(1 + i % 4), 0, LOSS, 2 * (uint32_t)i + 1);
+        linkInit(&ch->acks, 100 * (uint32_t)(1 + i % 4), 0, LOSS, 2 * (uint32_t)i + 2);
+        arqSenderInit(&ch->sender, ARQ_STOP_AND_WAIT, 1, &ch->data, &ch->acks, BUFFERS, fill, ch,
+                      TIMEOUT * 1000, 100);
+        arqReceiverInit(&ch->receiver, ARQ_STOP_AND_WAIT, 1, &ch->data, &ch->acks, BUFFERS, deliver, ch);
     }
 
-    if (data_valid)
+    // Laço de varredura até todos os transmissores terminarem; o transmissor que terminou não é
+    // chamado de novo (recomeçaria) e os receptores seguem confirmando retransmissões
+    while (live > 0)
     {
-        printf("Receptor: Dados corretos. Enviando ACK...\n");
-        ack_flag = 1; // Envia ACK
+        for (int i = 0; i < count; i++)
+        {
+            Channel *ch = &channels[i];
+            if (!ch->sender_done)
+            {
+                bool running = PT_PROFILE_SCHEDULE(&sender_profile, &ch->sender.pt, arqSenderRun(&ch->sender));
+                if (ch->sender.timeouts != ch->timeouts)
+                {
+                    ch->timeouts = ch->sender.timeouts;
+                    printf("Transmissor %d: Timeout. Reenviando dados (RTO %u ms)...\n", i, ch->sender.rto);
+                }
+                if (!running)
+                {
+                    printf("Transmissor %d: ACK de todos os %d buffers recebido (%llu retransmissões, "
+                           "RTO %u ms).\n", i, BUFFERS, (unsigned long long)ch->sender.retransmissions,
+                           ch->sender.rto);
+                    ch->sender_done = true;
+                    live--;
+                }
+            }
+            (void)PT_PROFILE_SCHEDULE(&receiver_profile, &ch->receiver.pt, arqReceiverRun(&ch->receiver));
+        }
+        // Dorme (ou, simulando, salta) até o próximo prazo: chegada de um quadro ou RTO
+        if (live > 0)
+        {
+            ptClockIdle(1000);
+        }
+        ptProfileDumpEvery(stderr, 2000);
     }
-    else
+    ptProfileDump(stderr);
+    if (simulate)
     {
-        printf("Receptor: Dados incorretos. Aguardando novos dados...\n");
+        printf("Tempo simulado: %u ms\n", ptClockMs());
     }
 
-    PT_END(pt);
-}
-
-// Função principal
-int main()
-{
-    PT_INIT(&pt_sender);
-    PT_INIT(&pt_receiver);
-
-    sender(&pt_sender);
-    receiver(&pt_receiver);
-
+    free(channels);
     return 0;
 }